@@ -7,6 +7,7 @@
 let matrixState = new Array(25).fill(null);
 let selectedColor = '#ff0000';
 let animationInterval = null;
+let deviceEffect = null;
 
 // OLED lines buffer
 let oledLines = ['', '', '', '', '', '', '', ''];
@@ -14,6 +15,20 @@ let oledLines = ['', '', '', '', '', '', '', ''];
 // Polling interval (ms)
 const POLL_INTERVAL = 200;
 
+// WebSocket control channel (binary commands, see ws_command_handler in the firmware)
+const WS_PORT = 8080;
+const WS_CMD_MATRIX = 0x01;
+const WS_CMD_RGB = 0x02;
+const WS_CMD_OLED = 0x03;
+const WS_CMD_BUZZER = 0x04;
+let controlSocket = null;
+
+// POST fallback: ask for an empty 204 instead of the re-rendered index page
+const FORM_HEADERS = {
+    'Content-Type': 'application/x-www-form-urlencoded',
+    'Prefer': 'return=minimal'
+};
+
 // ============================================
 // Initialization
 // ============================================
@@ -22,9 +37,36 @@ document.addEventListener('DOMContentLoaded', () => {
     initLedMatrix();
     initOledInput();
     startPolling();
+    connectControlSocket();
     updateRGB();
 });
 
+// ============================================
+// WebSocket Control Channel
+// ============================================
+
+function connectControlSocket() {
+    if (!window.WebSocket) return;
+    const ws = new WebSocket(`ws://${location.hostname}:${WS_PORT}/ws`);
+    ws.binaryType = 'arraybuffer';
+    ws.onopen = () => { controlSocket = ws; };
+    ws.onclose = () => {
+        // Commands fall back to HTTP POST until the socket is back
+        controlSocket = null;
+        setTimeout(connectControlSocket, 3000);
+    };
+}
+
+// Send a binary command; returns false when the caller should use HTTP instead
+function sendCommand(cmd, payload) {
+    if (!controlSocket || controlSocket.readyState !== WebSocket.OPEN) return false;
+    const frame = new Uint8Array(1 + payload.length);
+    frame[0] = cmd;
+    frame.set(payload, 1);
+    controlSocket.send(frame);
+    return true;
+}
+
 // ============================================
 // LED Matrix Functions
 // ============================================
@@ -131,6 +173,13 @@ function sendMatrix() {
         flippedData[flipIndex(i)] = matrixState[i];
     }
     
+    const frame = new Uint8Array(75);
+    flippedData.forEach((color, i) => {
+        const c = color && hexToRgb(color);
+        if (c) frame.set([c.r, c.g, c.b], i * 3);
+    });
+    if (sendCommand(WS_CMD_MATRIX, frame)) return;
+    
     const data = flippedData.map(color => {
         if (!color) return '000000';
         return color.replace('#', '');
@@ -138,7 +187,7 @@ function sendMatrix() {
     
     fetch('/matrix.cgi', {
         method: 'POST',
-        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },
+        headers: FORM_HEADERS,
         body: `data=${encodeURIComponent(data)}`
     }).then(response => {
         if (response.ok) {
@@ -147,12 +196,35 @@ function sendMatrix() {
     }).catch(err => console.error('Matrix send error:', err));
 }
 
-// Stop any running animation
+// Start an effect on the device; the local setInterval only animates the preview
+function startEffect(name, extra = '') {
+    const color = document.getElementById('led-color').value.replace('#', '');
+    fetch('/fx.cgi', {
+        method: 'POST',
+        headers: FORM_HEADERS,
+        body: `fx=${name}&color=${color}${extra}`
+    }).then(response => {
+        if (response.ok) {
+            console.log(`Effect ${name} started`);
+        }
+    }).catch(err => console.error('Effect start error:', err));
+    deviceEffect = name;
+}
+
+// Stop any running animation (preview and device effect)
 function stopAnimation() {
     if (animationInterval) {
         clearInterval(animationInterval);
         animationInterval = null;
     }
+    if (deviceEffect) {
+        deviceEffect = null;
+        fetch('/fx.cgi', {
+            method: 'POST',
+            headers: FORM_HEADERS,
+            body: 'stop=1'
+        }).catch(err => console.error('Effect stop error:', err));
+    }
 }
 
 // Helper to update LED visually
@@ -168,6 +240,7 @@ function setLedVisual(idx, color) {
 // Wave effect from top to bottom
 function waveTopBottom() {
     stopAnimation();
+    startEffect('wave_down');
     selectedColor = document.getElementById('led-color').value;
     let row = 0;
     animationInterval = setInterval(() => {
@@ -175,7 +248,6 @@ function waveTopBottom() {
         for (let col = 0; col < 5; col++) {
             setLedVisual(row * 5 + col, selectedColor);
         }
-        sendMatrix();
         row = (row + 1) % 5;
     }, 200);
 }
@@ -183,6 +255,7 @@ function waveTopBottom() {
 // Wave effect from bottom to top
 function waveBottomTop() {
     stopAnimation();
+    startEffect('wave_up');
     selectedColor = document.getElementById('led-color').value;
     let row = 4;
     animationInterval = setInterval(() => {
@@ -190,7 +263,6 @@ function waveBottomTop() {
         for (let col = 0; col < 5; col++) {
             setLedVisual(row * 5 + col, selectedColor);
         }
-        sendMatrix();
         row = (row - 1 + 5) % 5;
     }, 200);
 }
@@ -198,6 +270,7 @@ function waveBottomTop() {
 // Wave effect from left to right
 function waveLeftRight() {
     stopAnimation();
+    startEffect('wave_right');
     selectedColor = document.getElementById('led-color').value;
     let col = 0;
     animationInterval = setInterval(() => {
@@ -205,7 +278,6 @@ function waveLeftRight() {
         for (let row = 0; row < 5; row++) {
             setLedVisual(row * 5 + col, selectedColor);
         }
-        sendMatrix();
         col = (col + 1) % 5;
     }, 200);
 }
@@ -213,6 +285,7 @@ function waveLeftRight() {
 // Wave effect from right to left
 function waveRightLeft() {
     stopAnimation();
+    startEffect('wave_left');
     selectedColor = document.getElementById('led-color').value;
     let col = 4;
     animationInterval = setInterval(() => {
@@ -220,7 +293,6 @@ function waveRightLeft() {
         for (let row = 0; row < 5; row++) {
             setLedVisual(row * 5 + col, selectedColor);
         }
-        sendMatrix();
         col = (col - 1 + 5) % 5;
     }, 200);
 }
@@ -228,6 +300,7 @@ function waveRightLeft() {
 // Expanding wave from center
 function waveExpand() {
     stopAnimation();
+    startEffect('expand');
     selectedColor = document.getElementById('led-color').value;
     const rings = [
         [12],
@@ -238,7 +311,6 @@ function waveExpand() {
     animationInterval = setInterval(() => {
         clearMatrix(true);
         rings[ring].forEach(idx => setLedVisual(idx, selectedColor));
-        sendMatrix();
         ring = (ring + 1) % rings.length;
     }, 300);
 }
@@ -288,6 +360,7 @@ function rgbToHexColor(r, g, b) {
 // Effect: Rainbow Wave - Arco-iris percorrendo a matriz
 function effectRainbow() {
     stopAnimation();
+    startEffect('rainbow');
     let offset = 0;
     animationInterval = setInterval(() => {
         for (let i = 0; i < 25; i++) {
@@ -297,7 +370,6 @@ function effectRainbow() {
             const rgb = hsvToRgb(hue, 1, 1);
             setLedVisual(i, rgbToHexColor(rgb.r, rgb.g, rgb.b));
         }
-        sendMatrix();
         offset = (offset + 1) % 10;
     }, 150);
 }
@@ -305,6 +377,7 @@ function effectRainbow() {
 // Effect: Rainbow Spiral - Espiral arco-iris do centro
 function effectRainbowSpiral() {
     stopAnimation();
+    startEffect('spiral');
     const spiral = [12, 7, 11, 17, 13, 8, 6, 16, 18, 2, 1, 5, 10, 15, 20, 21, 22, 23, 19, 14, 9, 4, 3, 0, 24];
     let offset = 0;
     animationInterval = setInterval(() => {
@@ -313,7 +386,6 @@ function effectRainbowSpiral() {
             const rgb = hsvToRgb(hue, 1, 1);
             setLedVisual(i, rgbToHexColor(rgb.r, rgb.g, rgb.b));
         }
-        sendMatrix();
         offset = (offset + 1) % 25;
     }, 100);
 }
@@ -321,6 +393,7 @@ function effectRainbowSpiral() {
 // Effect: Color Chase - Cores perseguindo
 function effectColorChase() {
     stopAnimation();
+    startEffect('chase');
     const colors = ['#ff0000', '#00ff00', '#0000ff', '#ffff00', '#ff00ff', '#00ffff'];
     let pos = 0;
     let colorIdx = 0;
@@ -329,7 +402,6 @@ function effectColorChase() {
         setLedVisual(pos, colors[colorIdx]);
         setLedVisual((pos + 1) % 25, colors[(colorIdx + 1) % colors.length]);
         setLedVisual((pos + 2) % 25, colors[(colorIdx + 2) % colors.length]);
-        sendMatrix();
         pos = (pos + 1) % 25;
         if (pos === 0) colorIdx = (colorIdx + 1) % colors.length;
     }, 80);
@@ -338,6 +410,7 @@ function effectColorChase() {
 // Effect: Breathing - Respiracao com cor selecionada
 function effectBreathing() {
     stopAnimation();
+    startEffect('breathe');
     selectedColor = document.getElementById('led-color').value;
     const baseRgb = hexToRgb(selectedColor);
     let brightness = 0;
@@ -351,7 +424,6 @@ function effectBreathing() {
         for (let i = 0; i < 25; i++) {
             setLedVisual(i, color);
         }
-        sendMatrix();
         if (increasing) {
             brightness += 5;
             if (brightness >= 100) increasing = false;
@@ -365,6 +437,7 @@ function effectBreathing() {
 // Effect: Fire - Simulacao de fogo
 function effectFire() {
     stopAnimation();
+    startEffect('fire');
     animationInterval = setInterval(() => {
         for (let i = 0; i < 25; i++) {
             const row = Math.floor(i / 5);
@@ -375,13 +448,13 @@ function effectFire() {
             const b = 0;
             setLedVisual(i, rgbToHexColor(r, g, b));
         }
-        sendMatrix();
     }, 100);
 }
 
 // Effect: Sparkle - Brilhos aleatorios
 function effectSparkle() {
     stopAnimation();
+    startEffect('sparkle');
     animationInterval = setInterval(() => {
         clearMatrix(true);
         // Acende 3-5 LEDs aleatorios com cores aleatorias
@@ -392,13 +465,13 @@ function effectSparkle() {
             const rgb = hsvToRgb(hue, 1, 1);
             setLedVisual(idx, rgbToHexColor(rgb.r, rgb.g, rgb.b));
         }
-        sendMatrix();
     }, 100);
 }
 
 // Effect: Color Wheel - Roda de cores rotativa
 function effectColorWheel() {
     stopAnimation();
+    startEffect('wheel');
     let rotation = 0;
     animationInterval = setInterval(() => {
         for (let i = 0; i < 25; i++) {
@@ -412,7 +485,6 @@ function effectColorWheel() {
             const rgb = hsvToRgb(hue, 1, 1);
             setLedVisual(i, rgbToHexColor(rgb.r, rgb.g, rgb.b));
         }
-        sendMatrix();
         rotation = (rotation + 0.05) % 1;
     }, 100);
 }
@@ -420,6 +492,7 @@ function effectColorWheel() {
 // Effect: Gradient - Gradiente diagonal
 function effectGradient() {
     stopAnimation();
+    startEffect('gradient');
     let offset = 0;
     const color1 = hexToRgb(document.getElementById('led-color').value);
     // Cor complementar
@@ -434,7 +507,6 @@ function effectGradient() {
             const b = Math.round(color1.b + (color2.b - color1.b) * t);
             setLedVisual(i, rgbToHexColor(r, g, b));
         }
-        sendMatrix();
         offset = (offset + 1) % 8;
     }, 150);
 }
@@ -442,6 +514,7 @@ function effectGradient() {
 // Effect: Pulse - Pulso colorido do centro
 function effectPulse() {
     stopAnimation();
+    startEffect('pulse');
     let step = 0;
     const colors = ['#ff0000', '#ff7700', '#ffff00', '#00ff00', '#0077ff', '#8800ff'];
     animationInterval = setInterval(() => {
@@ -454,7 +527,6 @@ function effectPulse() {
             [0, 1, 2, 3, 4, 5, 9, 10, 14, 15, 19, 20, 21, 22, 23, 24]
         ];
         rings[ring].forEach(idx => setLedVisual(idx, colors[colorIdx]));
-        sendMatrix();
         step = (step + 1) % (3 * colors.length);
     }, 150);
 }
@@ -462,19 +534,20 @@ function effectPulse() {
 // Effect: Random Colors - Cores aleatorias em toda matriz
 function effectRandomColors() {
     stopAnimation();
+    startEffect('random');
     animationInterval = setInterval(() => {
         for (let i = 0; i < 25; i++) {
             const hue = Math.random();
             const rgb = hsvToRgb(hue, 1, 1);
             setLedVisual(i, rgbToHexColor(rgb.r, rgb.g, rgb.b));
         }
-        sendMatrix();
     }, 200);
 }
 
 // Effect: Matrix Rain - Chuva estilo Matrix
 function effectMatrixRain() {
     stopAnimation();
+    startEffect('rain');
     const drops = [0, 0, 0, 0, 0];
     animationInterval = setInterval(() => {
         clearMatrix(true);
@@ -492,13 +565,13 @@ function effectMatrixRain() {
                 drops[col] = (drops[col] + 1) % 5;
             }
         }
-        sendMatrix();
     }, 120);
 }
 
 // Effect: Ocean Waves - Ondas do oceano
 function effectOceanWaves() {
     stopAnimation();
+    startEffect('ocean');
     let phase = 0;
     animationInterval = setInterval(() => {
         for (let i = 0; i < 25; i++) {
@@ -511,7 +584,6 @@ function effectOceanWaves() {
             const b = Math.round(200 + 55 * wave);
             setLedVisual(i, rgbToHexColor(r, g, b));
         }
-        sendMatrix();
         phase += 0.5;
     }, 100);
 }
@@ -519,6 +591,7 @@ function effectOceanWaves() {
 // Effect: Lava Lamp - Lampada de lava
 function effectLavaLamp() {
     stopAnimation();
+    startEffect('lava');
     const blobs = [
         { x: 1, y: 2, hue: 0 },
         { x: 3, y: 1, hue: 0.3 },
@@ -545,13 +618,13 @@ function effectLavaLamp() {
                 }
             }
         });
-        sendMatrix();
     }, 100);
 }
 
 // Effect: Police Lights - Luzes de policia
 function effectPolice() {
     stopAnimation();
+    startEffect('police');
     let state = 0;
     animationInterval = setInterval(() => {
         clearMatrix(true);
@@ -570,7 +643,6 @@ function effectPolice() {
                 }
             }
         }
-        sendMatrix();
         state = (state + 1) % 4;
     }, 150);
 }
@@ -578,6 +650,7 @@ function effectPolice() {
 // Effect: Disco - Disco ball
 function effectDisco() {
     stopAnimation();
+    startEffect('disco');
     animationInterval = setInterval(() => {
         clearMatrix(true);
         // Acende LEDs aleatorios com cores vivas
@@ -587,10 +660,35 @@ function effectDisco() {
                 setLedVisual(i, colors[Math.floor(Math.random() * colors.length)]);
             }
         }
-        sendMatrix();
     }, 100);
 }
 
+// Effect: Blink - Pisca a matriz inteira com a cor selecionada
+function effectBlink() {
+    stopAnimation();
+    startEffect('blink');
+    selectedColor = document.getElementById('led-color').value;
+    let on = true;
+    animationInterval = setInterval(() => {
+        for (let i = 0; i < 25; i++) {
+            if (on) {
+                setLedVisual(i, selectedColor);
+            }
+        }
+        if (!on) clearMatrix(true);
+        on = !on;
+    }, 300);
+}
+
+// Effect: Scroll - Texto rolando na matriz (renderizado apenas no dispositivo)
+function effectScroll() {
+    stopAnimation();
+    clearMatrix(true);
+    const input = document.getElementById('oled-text');
+    const text = (input && input.value.trim()) || 'BitDogLab';
+    startEffect('scroll', `&text=${encodeURIComponent(text)}`);
+}
+
 // ============================================
 // OLED Functions
 // ============================================
@@ -621,9 +719,13 @@ function sendOledText() {
         updateOledPreview();
         
         // Send to device
+        if (sendCommand(WS_CMD_OLED, new TextEncoder().encode(text))) {
+            input.value = '';
+            return;
+        }
         fetch('/oled.cgi', {
             method: 'POST',
-            headers: { 'Content-Type': 'application/x-www-form-urlencoded' },
+            headers: FORM_HEADERS,
             body: `text=${encodeURIComponent(text)}`
         }).then(response => {
             if (response.ok) {
@@ -668,9 +770,13 @@ function playBuzzer(freq, dur) {
     // Get selected channel
     const channel = document.getElementById('buzzer-channel').value;
     
+    const chIndex = { both: 0, left: 1, right: 2 }[channel] ?? 0;
+    const f = parseInt(freq), d = parseInt(dur);
+    if (sendCommand(WS_CMD_BUZZER, [f & 0xFF, f >> 8, d & 0xFF, d >> 8, chIndex])) return;
+    
     fetch('/buzzer.cgi', {
         method: 'POST',
-        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },
+        headers: FORM_HEADERS,
         body: `freq=${freq}&dur=${dur}&ch=${channel}`
     }).then(response => {
         if (response.ok) {
@@ -679,6 +785,17 @@ function playBuzzer(freq, dur) {
     }).catch(err => console.error('Buzzer send error:', err));
 }
 
+function updateBuzzerQueue(depth, dropped) {
+    const label = depth > 0 ? `Tocando (${depth})` : 'Pronto';
+    ['bz-l-status', 'bz-r-status'].forEach(id => {
+        const el = document.getElementById(id);
+        if (el) {
+            el.textContent = label;
+            el.title = `Notas descartadas: ${dropped}`;
+        }
+    });
+}
+
 // ============================================
 // RGB LED Functions
 // ============================================
@@ -702,9 +819,11 @@ function sendRGB() {
     const g = document.getElementById('g-slider').value;
     const b = document.getElementById('b-slider').value;
     
+    if (sendCommand(WS_CMD_RGB, [r, g, b])) return;
+    
     fetch('/rgb.cgi', {
         method: 'POST',
-        headers: { 'Content-Type': 'application/x-www-form-urlencoded' },
+        headers: FORM_HEADERS,
         body: `r=${r}&g=${g}&b=${b}`
     }).then(response => {
         if (response.ok) {
@@ -718,40 +837,69 @@ function sendRGB() {
 // ============================================
 
 function startPolling() {
+    // Prefer the firmware's event stream; fall back to polling /api/state
+    if (window.EventSource) {
+        startEventStream();
+        return;
+    }
     pollState();
     setInterval(pollState, POLL_INTERVAL);
 }
 
+function startEventStream() {
+    const source = new EventSource('/api/events');
+    const on = (name, fn) => source.addEventListener(name, e => fn(JSON.parse(e.data)));
+    
+    on('state', applyState);
+    on('btn', s => {
+        updateButtonState('a', s.btna ? 'Pressionado' : 'Solto');
+        updateButtonState('b', s.btnb ? 'Pressionado' : 'Solto');
+        joyState.btn = !!s.joybtn;
+        updateJoystick(joyState.x, joyState.y, joyState.btn);
+    });
+    on('joy', s => {
+        joyState.x = s.joyx;
+        joyState.y = s.joyy;
+        updateJoystick(joyState.x, joyState.y, joyState.btn);
+    });
+    on('temp', s => updateTemperatureGauge(s.temp));
+    on('hb', s => {
+        document.getElementById('uptime').textContent = s.uptime;
+        updateBuzzerQueue(s.bzq, s.bzdrop);
+    });
+    
+    source.onerror = () => {
+        // The browser reconnects on its own unless the server refused the stream
+        if (source.readyState === EventSource.CLOSED) {
+            pollState();
+            setInterval(pollState, POLL_INTERVAL);
+        }
+    };
+}
+
+// Last joystick values, so partial events can redraw the whole widget
+const joyState = { x: 2048, y: 2048, btn: false };
+
+function applyState(s) {
+    // Buttons are 1 while pressed
+    updateButtonState('a', s.btna ? 'Pressionado' : 'Solto');
+    updateButtonState('b', s.btnb ? 'Pressionado' : 'Solto');
+    
+    joyState.x = s.joyx;
+    joyState.y = s.joyy;
+    joyState.btn = !!s.joybtn;
+    updateJoystick(joyState.x, joyState.y, joyState.btn);
+    
+    document.getElementById('uptime').textContent = s.uptime;
+    updateTemperatureGauge(s.temp);
+    updateBuzzerQueue(s.bzq, s.bzdrop);
+}
+
 function pollState() {
-    fetch('/state.shtml')
-        .then(response => response.text())
-        .then(html => {
-            // Parse the simple state response
-            const parser = new DOMParser();
-            const doc = parser.parseFromString(html, 'text/html');
-            
-            // Update button states
-            updateButtonState('a', doc.getElementById('btna')?.textContent);
-            updateButtonState('b', doc.getElementById('btnb')?.textContent);
-            
-            // Update joystick
-            const joyX = doc.getElementById('joyx')?.textContent || '2048';
-            const joyY = doc.getElementById('joyy')?.textContent || '2048';
-            const joyBtn = doc.getElementById('joybtn')?.textContent || '1';
-            updateJoystick(parseInt(joyX), parseInt(joyY), joyBtn === '0');
-            
-            // Update uptime
-            const uptime = doc.getElementById('uptime')?.textContent;
-            if (uptime) {
-                document.getElementById('uptime').textContent = uptime;
-            }
-            
-            // Update temperature gauge
-            const temp = doc.getElementById('temp')?.textContent;
-            if (temp) {
-                updateTemperatureGauge(parseFloat(temp));
-            }
-        })
+    // Compact JSON rendered by fs_open_custom() in the firmware
+    fetch('/api/state')
+        .then(response => response.json())
+        .then(applyState)
         .catch(err => {
             // Silent fail for polling
         });
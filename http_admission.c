@@ -0,0 +1,146 @@
+/**
+ * @file    http_admission.c
+ * @brief   Admissão de conexões por classe de pedido quando os PCBs acabam
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+#include "lwip/prot/tcp.h"
+#include "lwip/apps/httpd.h"
+
+#include "http_admission.h"
+#include "http_headers.h"
+#include "http_route.h"
+#include "http_sse.h"
+
+#if !MEMP_STATS
+#error "http_admission.c needs MEMP_STATS (see lwipopts.h)"
+#endif
+
+#define ADM_NEW_GRACE_TICKS ((HTTP_ADMISSION_NEW_GRACE_MS + TCP_SLOW_INTERVAL - 1) / TCP_SLOW_INTERVAL)
+#define ADM_KEEP            (-1)    // not a candidate for eviction
+
+static const char *const class_names[HTTP_ADMISSION_CLASS_COUNT] = {
+    [HTTP_ADMISSION_CLOSING] = "closing",
+    [HTTP_ADMISSION_IDLE] = "idle",
+    [HTTP_ADMISSION_NEW] = "new",
+    [HTTP_ADMISSION_POLL] = "poll",
+    [HTTP_ADMISSION_STREAM] = "stream",
+    [HTTP_ADMISSION_STATIC] = "static",
+    [HTTP_ADMISSION_CONTROL] = "control",
+};
+
+static http_admission_stats_t stats;
+
+// Class of a request from its method and path (the request line parsed by
+// http_headers.c); NULL path: not read yet, or longer than any route
+http_admission_class_t http_admission_classify(bool post, const char *path) {
+    if (post) {
+        return HTTP_ADMISSION_CONTROL;
+    }
+    if (path == NULL) {
+        return HTTP_ADMISSION_STATIC;
+    }
+    if (http_route_find(path) >= 0) {
+        return HTTP_ADMISSION_CONTROL;
+    }
+    if (strcmp(path, HTTP_SSE_URI) == 0) {
+        return HTTP_ADMISSION_STREAM;
+    }
+    if (strcmp(path, HTTP_ADMISSION_POLL_URI) == 0) {
+        return HTTP_ADMISSION_POLL;
+    }
+    return HTTP_ADMISSION_STATIC;
+}
+
+// Eviction class of an active pcb right now, ADM_KEEP when it must stay
+static int adm_evict_class(const struct tcp_pcb *pcb) {
+    if (pcb->state == FIN_WAIT_2) {
+        return HTTP_ADMISSION_CLOSING; // our FIN was acked: every byte delivered
+    }
+    if (pcb->state != ESTABLISHED || pcb->local_port != HTTPD_SERVER_PORT) {
+        return ADM_KEEP;
+    }
+    uint8_t cls;
+    u32_t snd_lbb;
+    if (!http_headers_conn_request(pcb, &cls, &snd_lbb)) {
+        return (u32_t)(tcp_ticks - pcb->tmr) >= ADM_NEW_GRACE_TICKS ? HTTP_ADMISSION_NEW : ADM_KEEP;
+    }
+    if (cls == HTTP_ADMISSION_STREAM) {
+        return HTTP_ADMISSION_STREAM;
+    }
+    // Response written since the request and all of it acknowledged: the
+    // connection is waiting for the next request
+    if (pcb->snd_lbb != snd_lbb && pcb->unsent == NULL && pcb->unacked == NULL) {
+        return HTTP_ADMISSION_IDLE;
+    }
+    return cls == HTTP_ADMISSION_POLL ? HTTP_ADMISSION_POLL : ADM_KEEP;
+}
+
+// SYN on a listening pcb: make room when the pool is full, or drop it
+static err_t adm_admit(void) {
+    const struct stats_mem *pool = lwip_stats.memp[MEMP_TCP_PCB];
+    if (pool->used < pool->avail || tcp_tw_pcbs != NULL) {
+        return ERR_OK; // a free pcb, or tcp_alloc() reuses the oldest TIME_WAIT one
+    }
+    struct tcp_pcb *victim = NULL;
+    int victim_cls = HTTP_ADMISSION_STATIC;
+    u32_t victim_idle = 0;
+    for (struct tcp_pcb *pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+        if (pcb->state == LAST_ACK || pcb->state == CLOSING) {
+            return ERR_OK; // tcp_alloc() kills these before anything else
+        }
+        int cls = adm_evict_class(pcb);
+        if (cls == ADM_KEEP) {
+            continue;
+        }
+        u32_t idle = tcp_ticks - pcb->tmr;
+        if (cls < victim_cls || (cls == victim_cls && idle >= victim_idle)) {
+            victim = pcb;
+            victim_cls = cls;
+            victim_idle = idle;
+        }
+    }
+    if (victim == NULL) {
+        stats.refused++;
+        LOG_TRACE("[ADM] Sem PCB livre nem conexão despejável: SYN descartado");
+        return ERR_ABRT;
+    }
+    stats.evicted[victim_cls]++;
+    LOG_TRACE("[ADM] Conexão %s despejada (porta %u)", class_names[victim_cls], victim->remote_port);
+    tcp_abort(victim);
+    return ERR_OK;
+}
+
+// Called from tcp_input (LWIP_HOOK_TCP_INPACKET_PCB) before the segment is
+// processed; ERR_ABRT drops a SYN that found no pcb. Request segments are
+// classified by http_headers_inpacket(), which parses them anyway
+err_t http_admission_inpacket(struct tcp_pcb *pcb, const struct tcp_hdr *hdr) {
+    if (pcb->state != LISTEN) {
+        return ERR_OK;
+    }
+    // Only a SYN makes tcp_listen_input() allocate a pcb
+    return (TCPH_FLAGS(hdr) & (TCP_SYN | TCP_ACK)) == TCP_SYN ? adm_admit() : ERR_OK;
+}
+
+const char *http_admission_class_name(http_admission_class_t cls) {
+    return cls < HTTP_ADMISSION_CLASS_COUNT ? class_names[cls] : "?";
+}
+
+void http_admission_get_stats(http_admission_stats_t *out) {
+    *out = stats;
+}
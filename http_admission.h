@@ -0,0 +1,78 @@
+/**
+ * @file    http_admission.h
+ * @brief   Admissão de conexões por classe de pedido quando os PCBs acabam
+ * @details Com MEMP_NUM_TCP_PCB conexões abertas o lwIP descarta o SYN
+ *          seguinte: todas as conexões do httpd têm a mesma prioridade, então
+ *          o tcp_alloc() não tem a quem tirar o PCB. Uma recarga de página
+ *          ou um comando de outro cliente espera as retransmissões do SYN
+ *          (1 s, 3 s...) enquanto navegadores ociosos seguram os PCBs.
+ *
+ *          Este módulo decide no hook LWIP_HOOK_TCP_INPACKET_PCB, antes do
+ *          tcp_listen_input(): com o pool cheio, escolhe uma conexão para
+ *          abortar e liberar o PCB do SYN que chegou. Cada conexão do httpd
+ *          é classificada pela linha do pedido, lida por http_headers.c
+ *          (http_admission_classify()), e a ordem de despejo é a
+ *          ordem do enum abaixo. Dentro da classe sai a mais antiga sem
+ *          tráfego.
+ *          - conexões já fechadas do nosso lado, esperando o FIN do cliente
+ *            (FIN_WAIT_2, todos os dados entregues);
+ *          - keep-alive ociosa: resposta enviada e confirmada, à espera do
+ *            próximo pedido;
+ *          - aceita sem pedido há HTTP_ADMISSION_NEW_GRACE_MS (as conexões
+ *            especulativas que os navegadores abrem);
+ *          - consulta de estado (/api/state) em andamento: o app.js repete;
+ *          - stream SSE: o EventSource reconecta sozinho.
+ *          Arquivos em transferência, comandos (POST e rotas de CGI) e as
+ *          conexões do WebSocket nunca são despejados, então um comando
+ *          aceito não é interrompido. Sem candidato, o SYN é descartado e o
+ *          cliente tenta de novo.
+ *
+ *          Despejos por classe e recusas são contados e saem em /metrics.
+ *          Quando há PCBs em TIME_WAIT, LAST_ACK ou CLOSING, a recuperação
+ *          é a do próprio lwIP no tcp_alloc().
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_ADMISSION_H
+#define HTTP_ADMISSION_H
+
+#include "pico/stdlib.h"
+#include "lwip/err.h"
+
+struct tcp_pcb;
+struct tcp_hdr;
+
+// Tempo sem pedido a partir do qual uma conexão aceita pode ser despejada
+#define HTTP_ADMISSION_NEW_GRACE_MS     1000
+
+// Consulta de estado feita pelo app.js em polling
+#define HTTP_ADMISSION_POLL_URI         "/api/state"
+
+// Classes, na ordem de despejo; a partir de HTTP_ADMISSION_STATIC nunca
+typedef enum {
+    HTTP_ADMISSION_CLOSING = 0, // FIN_WAIT_2
+    HTTP_ADMISSION_IDLE,        // keep-alive entre pedidos
+    HTTP_ADMISSION_NEW,         // aceita, sem pedido
+    HTTP_ADMISSION_POLL,        // GET /api/state
+    HTTP_ADMISSION_STREAM,      // GET /api/events
+    HTTP_ADMISSION_STATIC,      // demais GETs (arquivos, /metrics)
+    HTTP_ADMISSION_CONTROL,     // POST e rotas de CGI
+    HTTP_ADMISSION_CLASS_COUNT
+} http_admission_class_t;
+
+typedef struct {
+    uint32_t evicted[HTTP_ADMISSION_STATIC]; // por classe despejável
+    uint32_t refused;                        // SYNs descartados sem candidato
+} http_admission_stats_t;
+
+// Funções públicas
+err_t http_admission_inpacket(struct tcp_pcb *pcb, const struct tcp_hdr *hdr);
+http_admission_class_t http_admission_classify(bool post, const char *path);
+const char *http_admission_class_name(http_admission_class_t cls);
+void http_admission_get_stats(http_admission_stats_t *out);
+
+#endif // HTTP_ADMISSION_H
@@ -0,0 +1,55 @@
+/**
+ * @file    http_cache.c
+ * @brief   ETag e respostas 304 Not Modified para o conteúdo embutido
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "http_cache.h"
+#include "http_headers.h"
+#include "http_keepalive.h"
+
+// If-None-Match uses the weak comparison: "*" or any listed tag, with or
+// without the W/ prefix. Our tags are quoted hex, so a plain substring
+// search cannot match part of another tag.
+bool http_cache_etag_match(const char *if_none_match, const char *etag) {
+    if (if_none_match == NULL) {
+        return false;
+    }
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL;
+}
+
+// Serve the prebuilt 304 of one representation when the client already
+// has it
+int http_cache_serve(struct fs_file *file, const http_cache_file_t *f) {
+    if (!http_cache_etag_match(http_headers_get(HTTP_HDR_IF_NONE_MATCH), f->etag)) {
+        return 0;
+    }
+    bool persistent = http_keepalive_allowed();
+    memset(file, 0, sizeof(struct fs_file));
+    file->data = persistent ? f->not_modified : f->not_modified_close;
+    file->len = persistent ? f->not_modified_len : f->not_modified_close_len;
+    file->index = file->len;
+    file->flags = http_keepalive_flags(); // bodiless: may stay open
+    return 1;
+}
+
+// Serve the prebuilt 304 when the client already has this version of the
+// file. Only requests carrying If-None-Match pay for the table lookup.
+int http_cache_open(struct fs_file *file, const char *name) {
+    if (http_headers_get(HTTP_HDR_IF_NONE_MATCH) == NULL) {
+        return 0;
+    }
+    for (uint16_t i = 0; i < http_cache_file_count; i++) {
+        const http_cache_file_t *f = &http_cache_files[i];
+        if (strcmp(f->name, name) == 0) {
+            return http_cache_serve(file, f); // first entry: the fsdata encoding
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file    http_cache.h
+ * @brief   ETag e respostas 304 Not Modified para o conteúdo embutido
+ * @details tools/makefsdata.py calcula um hash do corpo final de cada
+ *          arquivo estático, grava os cabeçalhos ETag e Cache-Control no
+ *          fsdata e gera esta tabela com a resposta 304 já montada. Quando
+ *          o If-None-Match da requisição (capturado por http_headers.c)
+ *          contém o ETag do arquivo, fs_open_custom() entrega a resposta
+ *          304 no lugar do arquivo, sem corpo.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+#include "pico/stdlib.h"
+#include "lwip/apps/fs.h"
+
+typedef struct {
+    const char *name;               // URI do arquivo no fsdata
+    const char *etag;               // Com as aspas
+    const char *not_modified;       // Resposta 304 completa (só cabeçalhos)
+    uint16_t not_modified_len;
+    const char *not_modified_close; // O mesmo 304 com "Connection: close"
+    uint16_t not_modified_close_len;
+} http_cache_file_t;
+
+// Tabela gerada junto com o fsdata (pico_fsdata.inc)
+extern const http_cache_file_t http_cache_files[];
+extern const uint16_t http_cache_file_count;
+
+// Funções públicas
+bool http_cache_etag_match(const char *if_none_match, const char *etag);
+int http_cache_serve(struct fs_file *file, const http_cache_file_t *f);
+int http_cache_open(struct fs_file *file, const char *name);
+
+#endif // HTTP_CACHE_H
@@ -0,0 +1,110 @@
+/**
+ * @file    http_chksum.c
+ * @brief   Checksums TCP pré-calculados para o conteúdo embutido
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/opt.h"
+#include "lwip/inet_chksum.h"
+
+#include "http_chksum.h"
+
+#if HTTPD_PRECALCULATED_CHECKSUM
+
+#if !LWIP_CHECKSUM_ON_COPY
+#error "HTTPD_PRECALCULATED_CHECKSUM needs LWIP_CHECKSUM_ON_COPY (see lwipopts.h)"
+#endif
+
+static http_chksum_stats_t stats;
+
+// Checksum of the block starting exactly at src with exactly len bytes,
+// NULL when src is not a block of an embedded file
+static const struct fsdata_chksum *chksum_find(const uint8_t *src, u16_t len) {
+    for (uint16_t i = 0; i < http_chksum_file_count; i++) {
+        const http_chksum_file_t *f = &http_chksum_files[i];
+        if (src < f->data || src >= f->data + f->len) {
+            continue;
+        }
+        uint32_t offset = (uint32_t)(src - f->data);
+        uint32_t block = offset / TCP_MSS;
+        if (offset % TCP_MSS != 0 || block >= f->chksum_count || f->chksum[block].len != len) {
+            return NULL;
+        }
+        return &f->chksum[block];
+    }
+    return NULL;
+}
+
+// LWIP_CHKSUM_COPY: same contract as lwip_chksum_copy(), i.e. the folded
+// one's complement sum of the copied bytes, not inverted
+u16_t http_chksum_copy(void *dst, const void *src, u16_t len) {
+    MEMCPY(dst, src, len);
+    const struct fsdata_chksum *c = chksum_find((const uint8_t *)src, len);
+    if (c != NULL) {
+        stats.precalc_bytes += len;
+        return c->chksum;
+    }
+    stats.computed_bytes += len;
+    return LWIP_CHKSUM(dst, len);
+}
+
+void http_chksum_get_stats(http_chksum_stats_t *out) {
+    *out = stats;
+}
+
+// Copy every block of the embedded files into a segment-sized buffer, once
+// computing the checksum as the default path does and once through the
+// table, and log the throughput of each
+void http_chksum_benchmark(void) {
+    uint8_t *buf = malloc(TCP_MSS);
+    if (buf == NULL) {
+        return;
+    }
+    uint32_t bytes = 0;
+    volatile u16_t sink = 0; // keeps the checksums from being optimized out
+
+    uint32_t t0 = time_us_32();
+    for (uint16_t i = 0; i < http_chksum_file_count; i++) {
+        const http_chksum_file_t *f = &http_chksum_files[i];
+        for (uint16_t b = 0; b < f->chksum_count; b++) {
+            MEMCPY(buf, f->data + f->chksum[b].offset, f->chksum[b].len);
+            sink ^= LWIP_CHKSUM(buf, f->chksum[b].len);
+            bytes += f->chksum[b].len;
+        }
+    }
+    uint32_t t_sw = time_us_32() - t0;
+
+    http_chksum_stats_t saved = stats;
+    t0 = time_us_32();
+    for (uint16_t i = 0; i < http_chksum_file_count; i++) {
+        const http_chksum_file_t *f = &http_chksum_files[i];
+        for (uint16_t b = 0; b < f->chksum_count; b++) {
+            sink ^= http_chksum_copy(buf, f->data + f->chksum[b].offset, f->chksum[b].len);
+        }
+    }
+    uint32_t t_pre = time_us_32() - t0;
+    stats = saved;
+    free(buf);
+
+    if (t_sw == 0 || t_pre == 0) {
+        return;
+    }
+    LOG_INFO("[CHKSUM] %lu bytes: cópia+checksum %lu us (%lu KB/s), cópia+tabela %lu us (%lu KB/s)",
+             (unsigned long)bytes,
+             (unsigned long)t_sw, (unsigned long)((uint64_t)bytes * 1000000 / 1024 / t_sw),
+             (unsigned long)t_pre, (unsigned long)((uint64_t)bytes * 1000000 / 1024 / t_pre));
+}
+
+#endif // HTTPD_PRECALCULATED_CHECKSUM
@@ -0,0 +1,57 @@
+/**
+ * @file    http_chksum.h
+ * @brief   Checksums TCP pré-calculados para o conteúdo embutido
+ * @details Com HTTPD_PRECALCULATED_CHECKSUM (opção PICO_HTTPD_PRECALC_CHECKSUM
+ *          do CMake), tools/makefsdata.py divide cada arquivo estático em
+ *          blocos de TCP_MSS bytes, a partir do início da resposta, e grava
+ *          o checksum de cada bloco no fsdata.
+ *
+ *          O httpd do lwIP não consome esses checksums por conta própria.
+ *          O lwIP é configurado com LWIP_CHECKSUM_ON_COPY, que calcula o
+ *          checksum dos dados durante a cópia para o segmento, e a cópia é
+ *          substituída por http_chksum_copy() (LWIP_CHKSUM_COPY): quando o
+ *          trecho copiado é exatamente um bloco do fsdata, o checksum vem da
+ *          tabela e o Cortex-M0+ só faz o memcpy. Qualquer outro trecho
+ *          (respostas dinâmicas, SSI, segmentos desalinhados) é calculado em
+ *          software, como antes.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_CHKSUM_H
+#define HTTP_CHKSUM_H
+
+#include "pico/stdlib.h"
+#include "lwip/apps/fs.h"
+
+#if HTTPD_PRECALCULATED_CHECKSUM
+
+// Arquivo estático com os checksums dos seus blocos
+typedef struct {
+    const uint8_t *data;                // Início da resposta (cabeçalho incluído)
+    uint32_t len;
+    const struct fsdata_chksum *chksum; // Um por bloco de TCP_MSS, em ordem
+    uint16_t chksum_count;
+} http_chksum_file_t;
+
+// Tabela gerada junto com o fsdata (pico_fsdata.inc)
+extern const http_chksum_file_t http_chksum_files[];
+extern const uint16_t http_chksum_file_count;
+
+// Bytes copiados para segmentos TCP por origem do checksum
+typedef struct {
+    uint32_t precalc_bytes;             // Checksum lido da tabela
+    uint32_t computed_bytes;            // Checksum calculado em software
+} http_chksum_stats_t;
+
+// Funções públicas
+u16_t http_chksum_copy(void *dst, const void *src, u16_t len);
+void http_chksum_get_stats(http_chksum_stats_t *out);
+void http_chksum_benchmark(void);
+
+#endif // HTTPD_PRECALCULATED_CHECKSUM
+
+#endif // HTTP_CHKSUM_H
@@ -0,0 +1,73 @@
+/**
+ * @file    http_encoding.c
+ * @brief   Negociação de Content-Encoding para o conteúdo embutido
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "http_encoding.h"
+#include "http_headers.h"
+#include "http_keepalive.h"
+
+// Content-coding tokens, indexed by http_encoding_t
+static const char *const encoding_tokens[HTTP_ENCODING_COUNT] = {
+    [HTTP_ENCODING_BR] = "br",
+    [HTTP_ENCODING_GZIP] = "gzip",
+    [HTTP_ENCODING_IDENTITY] = "identity",
+};
+
+// Stored variant the client weights highest; ties go to the smaller one.
+// Returns HTTP_ENCODING_COUNT when the client accepts none of them
+static http_encoding_t encoding_select(const http_encoding_file_t *f, const char *accept) {
+    if (accept == NULL) {
+        // No header: anything goes, but plain clients (curl, scripts) get
+        // the uncompressed file when there is one
+        return f->variants[HTTP_ENCODING_IDENTITY].file ? HTTP_ENCODING_IDENTITY : f->fsdata_encoding;
+    }
+    http_encoding_t best = HTTP_ENCODING_COUNT;
+    int best_q = 0;
+    for (int e = 0; e < HTTP_ENCODING_COUNT; e++) {
+        if (f->variants[e].file == NULL) {
+            continue;
+        }
+        int q = http_headers_list_q(accept, encoding_tokens[e]);
+        if (q < 0) {
+            q = (e == HTTP_ENCODING_IDENTITY) ? 1 : 0; // identity is acceptable unless refused
+        }
+        if (q > best_q) {
+            best = (http_encoding_t)e;
+            best_q = q;
+        }
+    }
+    return best;
+}
+
+// Serve the variant picked by Accept-Encoding when it is not the fsdata
+// entry. The fsdata entry itself goes through the usual path (304 table,
+// keep-alive cap, fsdata image), so this returns 0 for it.
+int http_encoding_open(struct fs_file *file, const char *name) {
+    for (uint16_t i = 0; i < http_encoding_file_count; i++) {
+        const http_encoding_file_t *f = &http_encoding_files[i];
+        if (strcmp(f->name, name) != 0) {
+            continue;
+        }
+        http_encoding_t e = encoding_select(f, http_headers_get(HTTP_HDR_ACCEPT_ENCODING));
+        if (e == HTTP_ENCODING_COUNT || e == f->fsdata_encoding) {
+            return 0;
+        }
+        const http_encoding_variant_t *v = &f->variants[e];
+        if (v->cache != NULL && http_cache_serve(file, v->cache)) {
+            return 1;
+        }
+        if (!http_keepalive_allowed() && v->last != NULL) {
+            return http_keepalive_serve_last(file, v->last);
+        }
+        return http_fsdata_open_file(file, v->file, 0);
+    }
+    return 0;
+}
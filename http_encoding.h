@@ -0,0 +1,62 @@
+/**
+ * @file    http_encoding.h
+ * @brief   Negociação de Content-Encoding para o conteúdo embutido
+ * @details tools/makefsdata.py pode gravar mais de uma variante de cada
+ *          arquivo estático: gzip (a entrada normal do fsdata), br
+ *          (PICO_HTTPD_BROTLI) e o arquivo sem compressão
+ *          (PICO_HTTPD_IDENTITY_FALLBACK). Os arquivos com mais de uma
+ *          variante entram nesta tabela, e fs_open_custom() escolhe a de
+ *          maior qvalue no Accept-Encoding da requisição (capturado por
+ *          http_headers.c); no empate vale a ordem de http_encoding_t, da
+ *          menor para a maior. Sem Accept-Encoding, a variante sem compressão
+ *          é a preferida. Se nenhuma variante gravada for aceita, o arquivo
+ *          do fsdata é enviado como antes.
+ *
+ *          Cada variante tem seu próprio ETag, e todas saem com "Vary:
+ *          Accept-Encoding".
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_ENCODING_H
+#define HTTP_ENCODING_H
+
+#include "pico/stdlib.h"
+#include "lwip/apps/fs.h"
+
+#include "http_cache.h"
+#include "http_keepalive.h"
+
+struct fsdata_file;
+
+// Codificações, na ordem de preferência (mesma ordem do gerador)
+typedef enum {
+    HTTP_ENCODING_BR = 0,
+    HTTP_ENCODING_GZIP,
+    HTTP_ENCODING_IDENTITY,
+    HTTP_ENCODING_COUNT
+} http_encoding_t;
+
+typedef struct {
+    const struct fsdata_file *file;     // NULL = variante não gravada
+    const http_cache_file_t *cache;     // ETag e 304 da variante, NULL se não houver
+    const http_keepalive_file_t *last;  // Variante "Connection: close", NULL se não houver
+} http_encoding_variant_t;
+
+typedef struct {
+    const char *name;                   // URI do arquivo no fsdata
+    http_encoding_t fsdata_encoding;    // Variante que é a entrada do fsdata
+    http_encoding_variant_t variants[HTTP_ENCODING_COUNT];
+} http_encoding_file_t;
+
+// Tabela gerada junto com o fsdata (pico_fsdata.inc)
+extern const http_encoding_file_t http_encoding_files[];
+extern const uint16_t http_encoding_file_count;
+
+// Funções públicas
+int http_encoding_open(struct fs_file *file, const char *name);
+
+#endif // HTTP_ENCODING_H
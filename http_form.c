@@ -0,0 +1,155 @@
+/**
+ * @file    http_form.c
+ * @brief   Tokenizador incremental de corpos application/x-www-form-urlencoded
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "http_form.h"
+
+static int form_hex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hand the decoded bytes of a streamed value to the consumer
+static void form_flush(http_form_t *form) {
+    if (form->mode == HTTP_FORM_STREAM && form->value_len > 0) {
+        form->on_chunk(form->arg, form->key, form->value, form->value_len);
+        form->value_len = 0;
+    }
+}
+
+// Append one decoded byte to the key or value being built
+static void form_put(http_form_t *form, char c) {
+    if (form->in_value) {
+        if (form->mode == HTTP_FORM_SKIP) {
+            return;
+        }
+        if (form->mode == HTTP_FORM_STREAM && form->value_len == HTTP_FORM_VALUE_MAX) {
+            form_flush(form);
+        }
+        if (form->value_len < HTTP_FORM_VALUE_MAX - 1 || form->mode == HTTP_FORM_STREAM) {
+            form->value[form->value_len++] = c;
+        } else {
+            form->overflow = true;
+        }
+    } else {
+        if (form->key_len < HTTP_FORM_KEY_MAX - 1) {
+            form->key[form->key_len++] = c;
+        } else {
+            form->overflow = true;
+        }
+    }
+}
+
+// End of a pair ('&' or end of body): deliver it and reset for the next one
+static void form_emit(http_form_t *form) {
+    if (form->mode == HTTP_FORM_STREAM) {
+        form_flush(form);
+        form->on_chunk(form->arg, form->key, NULL, 0);
+    } else if (form->mode == HTTP_FORM_BUFFER && form->key_len > 0 && form->on_pair) {
+        form->key[form->key_len] = '\0';
+        form->value[form->value_len] = '\0';
+        // A dropped pair is still reported so the consumer can reset
+        form->on_pair(form->arg, form->key, form->overflow ? NULL : form->value, form->value_len);
+    }
+    form->in_value = false;
+    form->in_escape = false;
+    form->overflow = false;
+    form->mode = HTTP_FORM_BUFFER;
+    form->key_len = 0;
+    form->value_len = 0;
+}
+
+void http_form_init(http_form_t *form, http_form_pair_fn on_pair, void *arg) {
+    memset(form, 0, sizeof(*form));
+    form->on_pair = on_pair;
+    form->arg = arg;
+}
+
+void http_form_set_stream(http_form_t *form, http_form_key_fn on_key, http_form_chunk_fn on_chunk) {
+    form->on_key = on_key;
+    form->on_chunk = on_chunk;
+}
+
+// Key complete: ask the consumer how to handle its value
+static void form_begin_value(http_form_t *form) {
+    form->in_value = true;
+    form->key[form->key_len] = '\0';
+    form->mode = HTTP_FORM_BUFFER;
+    if (form->overflow || form->key_len == 0) {
+        form->mode = HTTP_FORM_SKIP;
+    } else if (form->on_key) {
+        form->mode = form->on_key(form->arg, form->key);
+        if (form->mode == HTTP_FORM_STREAM && form->on_chunk == NULL) {
+            form->mode = HTTP_FORM_SKIP;
+        }
+    }
+}
+
+void http_form_feed(http_form_t *form, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+
+        if (form->in_escape) {
+            int v = form_hex(c);
+            if (v < 0) {
+                form->in_escape = false; // malformed %XX: drop it
+            } else {
+                form->esc_value = (uint8_t)(form->esc_value << 4 | v);
+                if (++form->esc_digits == 2) {
+                    form->in_escape = false;
+                    form_put(form, (char)form->esc_value);
+                }
+                continue;
+            }
+        }
+
+        switch (c) {
+            case '&':
+                form_emit(form);
+                break;
+            case '=':
+                if (form->in_value) {
+                    form_put(form, c);
+                } else {
+                    form_begin_value(form);
+                }
+                break;
+            case '+':
+                form_put(form, ' ');
+                break;
+            case '%':
+                form->in_escape = true;
+                form->esc_digits = 0;
+                form->esc_value = 0;
+                break;
+            case '\r':
+            case '\n':
+                break; // tolerate a trailing CRLF after the body
+            default:
+                form_put(form, c);
+                break;
+        }
+    }
+    // Nothing of a streamed value is held back between calls
+    form_flush(form);
+}
+
+void http_form_feed_pbuf(http_form_t *form, const struct pbuf *p) {
+    for (const struct pbuf *q = p; q != NULL; q = q->next) {
+        http_form_feed(form, (const char *)q->payload, q->len);
+    }
+}
+
+void http_form_finish(http_form_t *form) {
+    form_emit(form);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file    http_form.h
+ * @brief   Tokenizador incremental de corpos application/x-www-form-urlencoded
+ * @details Percorre os bytes do corpo uma única vez, decodificando chave e
+ *          valor (%XX e '+') enquanto copia, e entrega cada par completo a
+ *          um callback. O estado fica na estrutura do parser, então o corpo
+ *          pode chegar em qualquer número de pbufs ou chamadas.
+ *
+ *          Chaves marcadas como stream não são acumuladas: o valor é entregue
+ *          em pedaços já decodificados à medida que chega, e o tamanho fica
+ *          limitado apenas pelo destino (matriz, framebuffer, fila de notas).
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_FORM_H
+#define HTTP_FORM_H
+
+#include "pico/stdlib.h"
+#include "lwip/pbuf.h"
+
+// Maior chave aceita (incluindo o terminador)
+#define HTTP_FORM_KEY_MAX       16
+
+// Maior valor acumulado (incluindo o terminador); valores maiores são
+// descartados. Também é o maior pedaço entregue às chaves em stream.
+#define HTTP_FORM_VALUE_MAX     256
+
+// Como tratar o valor de uma chave
+typedef enum {
+    HTTP_FORM_BUFFER = 0,       // Acumula e entrega o par completo
+    HTTP_FORM_STREAM,           // Entrega o valor em pedaços
+    HTTP_FORM_SKIP,             // Descarta o valor
+} http_form_mode_t;
+
+// Recebe um par decodificado; value é terminado em '\0' e pode ser alterado.
+// value == NULL: par descartado (chave ou valor maior que o buffer)
+typedef void (*http_form_pair_fn)(void *arg, const char *key, char *value, size_t len);
+
+// Escolhe o modo do valor assim que a chave termina ('=')
+typedef http_form_mode_t (*http_form_key_fn)(void *arg, const char *key);
+
+// Recebe um pedaço de um valor em stream; data == NULL marca o fim do valor
+typedef void (*http_form_chunk_fn)(void *arg, const char *key, const char *data, size_t len);
+
+typedef struct {
+    bool in_value;              // Depois do '=' do par atual
+    bool in_escape;             // Dentro de um %XX
+    uint8_t esc_digits;         // Dígitos hexadecimais já lidos do %XX
+    uint8_t esc_value;
+    bool overflow;              // Chave ou valor atual não coube no buffer
+    uint8_t mode;               // http_form_mode_t do valor atual
+    uint8_t key_len;
+    uint16_t value_len;
+    char key[HTTP_FORM_KEY_MAX];
+    char value[HTTP_FORM_VALUE_MAX];
+    http_form_pair_fn on_pair;
+    http_form_key_fn on_key;
+    http_form_chunk_fn on_chunk;
+    void *arg;
+} http_form_t;
+
+// Funções públicas
+void http_form_init(http_form_t *form, http_form_pair_fn on_pair, void *arg);
+void http_form_set_stream(http_form_t *form, http_form_key_fn on_key, http_form_chunk_fn on_chunk);
+void http_form_feed(http_form_t *form, const char *data, size_t len);
+void http_form_feed_pbuf(http_form_t *form, const struct pbuf *p);
+void http_form_finish(http_form_t *form);
+
+#endif // HTTP_FORM_H
@@ -0,0 +1,312 @@
+/**
+ * @file    http_headers.c
+ * @brief   Captura dos cabeçalhos das requisições do httpd do lwIP
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include "lwip/tcp.h"
+#include "lwip/apps/httpd.h"
+
+#include "http_headers.h"
+#include "http_admission.h"
+
+// Lower-case names, indexed by http_header_id_t
+static const char *const header_names[HTTP_HDR_COUNT] = {
+    [HTTP_HDR_IF_NONE_MATCH] = "if-none-match",
+    [HTTP_HDR_ACCEPT_ENCODING] = "accept-encoding",
+    [HTTP_HDR_ACCEPT] = "accept",
+    [HTTP_HDR_PREFER] = "prefer",
+};
+
+typedef enum {
+    HDR_REQUEST_LINE = 0,
+    HDR_NAME,
+    HDR_VALUE,
+    HDR_BODY,           // blank line seen: nothing else to capture
+} hdr_state_t;
+
+typedef enum {
+    PATH_METHOD = 0,    // before the first space
+    PATH_READING,
+    PATH_DONE,
+    PATH_TOO_LONG,
+} path_state_t;
+
+static struct {
+    const struct tcp_pcb *pcb;  // connection being parsed
+    uint8_t state;              // hdr_state_t
+    int8_t field;               // header whose value is being read, -1 = none
+    uint8_t name_len;           // HTTP_HEADERS_NAME_MAX = name too long
+    uint8_t value_len;
+    uint8_t path_state;         // path_state_t
+    uint8_t path_len;
+    bool post;                  // request method is POST
+    char name[HTTP_HEADERS_NAME_MAX];
+    char values[HTTP_HDR_COUNT][HTTP_HEADERS_VALUE_MAX];
+    char path[HTTP_HEADERS_PATH_MAX];
+} hdr;
+
+// Requests seen on each connection (keep-alive cap, admission class). lwIP
+// never has more than MEMP_NUM_TCP_PCB active pcbs, so one entry per pcb
+// address is enough; the remote port tells a recycled pcb from the same
+// connection.
+typedef struct {
+    const struct tcp_pcb *pcb;
+    u16_t remote_port;
+    uint16_t requests;
+    uint32_t start_us;          // arrival of the current request
+    uint8_t cls;                // http_admission_class_t of the current request
+    u32_t snd_lbb;              // send buffer position when it arrived
+} hdr_conn_t;
+
+static hdr_conn_t conns[MEMP_NUM_TCP_PCB];
+static hdr_conn_t *conn_current;
+
+static hdr_conn_t *hdr_conn_for(const struct tcp_pcb *pcb) {
+    hdr_conn_t *free_slot = NULL;
+    for (int i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+        if (conns[i].pcb == pcb) {
+            if (conns[i].remote_port != pcb->remote_port) {
+                conns[i].remote_port = pcb->remote_port; // new connection on a recycled pcb
+                conns[i].requests = 0;
+            }
+            return &conns[i];
+        }
+        if (conns[i].pcb == NULL && free_slot == NULL) {
+            free_slot = &conns[i];
+        }
+    }
+    if (free_slot == NULL) {
+        free_slot = &conns[0]; // not reached: one slot per pcb of the pool
+    }
+    free_slot->pcb = pcb;
+    free_slot->remote_port = pcb->remote_port;
+    free_slot->requests = 0;
+    return free_slot;
+}
+
+static void hdr_reset(const struct tcp_pcb *pcb, hdr_state_t state) {
+    hdr.pcb = pcb;
+    hdr.state = state;
+    hdr.field = -1;
+    hdr.name_len = 0;
+    hdr.path_state = PATH_METHOD;
+    hdr.path_len = 0;
+    hdr.path[0] = '\0';
+    for (int i = 0; i < HTTP_HDR_COUNT; i++) {
+        hdr.values[i][0] = '\0';
+    }
+}
+
+// Path of the request line, up to the query string
+static void hdr_path_feed(char c) {
+    if (hdr.path_state == PATH_METHOD) {
+        if (c == ' ') {
+            hdr.path_state = PATH_READING;
+        }
+    } else if (hdr.path_state == PATH_READING) {
+        if (c == ' ' || c == '?' || c == '\n') {
+            hdr.path[hdr.path_len] = '\0';
+            hdr.path_state = PATH_DONE;
+            conn_current->cls = http_admission_classify(hdr.post, hdr.path);
+        } else if (hdr.path_len < HTTP_HEADERS_PATH_MAX - 1) {
+            hdr.path[hdr.path_len++] = c;
+        } else {
+            hdr.path[0] = '\0';
+            hdr.path_state = PATH_TOO_LONG;
+        }
+    }
+}
+
+// A segment starting with a method begins a new request on the connection
+static bool hdr_is_request_start(const struct pbuf *p) {
+    return pbuf_memcmp(p, 0, "GET ", 4) == 0 ||
+           pbuf_memcmp(p, 0, "POST ", 5) == 0 ||
+           pbuf_memcmp(p, 0, "HEAD ", 5) == 0;
+}
+
+static void hdr_name_end(void) {
+    hdr.field = -1;
+    hdr.value_len = 0;
+    if (hdr.name_len < HTTP_HEADERS_NAME_MAX) {
+        for (int i = 0; i < HTTP_HDR_COUNT; i++) {
+            if (strlen(header_names[i]) == hdr.name_len &&
+                memcmp(header_names[i], hdr.name, hdr.name_len) == 0) {
+                hdr.field = i;
+                break;
+            }
+        }
+    }
+    hdr.state = HDR_VALUE;
+}
+
+static void hdr_feed(const char *data, size_t len) {
+    for (size_t i = 0; i < len && hdr.state != HDR_BODY; i++) {
+        char c = data[i];
+        if (c == '\r') {
+            continue;
+        }
+        switch (hdr.state) {
+            case HDR_REQUEST_LINE:
+                hdr_path_feed(c);
+                if (c == '\n') {
+                    hdr.state = HDR_NAME;
+                    hdr.name_len = 0;
+                }
+                break;
+            case HDR_NAME:
+                if (c == '\n') {
+                    // Blank line ends the headers; a line without ':' is dropped
+                    hdr.state = (hdr.name_len == 0) ? HDR_BODY : HDR_NAME;
+                    hdr.name_len = 0;
+                } else if (c == ':') {
+                    hdr_name_end();
+                } else if (hdr.name_len < HTTP_HEADERS_NAME_MAX) {
+                    hdr.name[hdr.name_len++] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+                }
+                break;
+            case HDR_VALUE:
+                if (c == '\n') {
+                    hdr.state = HDR_NAME;
+                    hdr.name_len = 0;
+                } else if (hdr.field >= 0 && (hdr.value_len > 0 || (c != ' ' && c != '\t')) &&
+                           hdr.value_len < HTTP_HEADERS_VALUE_MAX - 1) {
+                    char *value = hdr.values[hdr.field];
+                    value[hdr.value_len++] = c;
+                    value[hdr.value_len] = '\0';
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Called from tcp_input (LWIP_HOOK_TCP_INPACKET_PCB) with the payload at
+// the TCP data; never drops the segment
+err_t http_headers_inpacket(struct tcp_pcb *pcb, struct pbuf *p) {
+    if (pcb->local_port != HTTPD_SERVER_PORT || pcb->state == LISTEN || p->tot_len == 0) {
+        return ERR_OK;
+    }
+    if (hdr_is_request_start(p)) {
+        hdr_reset(pcb, HDR_REQUEST_LINE);
+        conn_current = hdr_conn_for(pcb);
+        conn_current->requests++;
+        conn_current->start_us = time_us_32();
+        conn_current->snd_lbb = pcb->snd_lbb;
+        hdr.post = pbuf_memcmp(p, 0, "POST ", 5) == 0;
+        conn_current->cls = http_admission_classify(hdr.post, NULL); // until the path is read
+    } else if (pcb != hdr.pcb) {
+        // Continuation of a request whose start was not followed (another
+        // connection was parsed meanwhile): capture nothing for it
+        hdr_reset(pcb, HDR_BODY);
+        conn_current = hdr_conn_for(pcb);
+        return ERR_OK;
+    }
+    for (const struct pbuf *q = p; q != NULL; q = q->next) {
+        hdr_feed((const char *)q->payload, q->len);
+    }
+    return ERR_OK;
+}
+
+// Value in the request being handled, NULL when absent. Valid while httpd
+// processes the segment that completed the request (fs_open, CGI, POST begin)
+const char *http_headers_get(http_header_id_t id) {
+    return hdr.values[id][0] != '\0' ? hdr.values[id] : NULL;
+}
+
+// qvalue in thousandths: "1", "0", "0.5", "0.125"
+static int accept_parse_q(const char *s) {
+    int q = (*s == '1') ? 1000 : 0;
+    if (*s != '0' && *s != '1') {
+        return 1000; // malformed: ignore the weight
+    }
+    s++;
+    if (*s == '.') {
+        s++;
+        for (int scale = 100; scale > 0 && *s >= '0' && *s <= '9'; scale /= 10, s++) {
+            q += (*s - '0') * scale;
+        }
+    }
+    return q > 1000 ? 1000 : q;
+}
+
+// Weight a comma-separated list ("gzip;q=0.5, br", "application/json")
+// gives to a token, case-insensitively: its own entry, else the "*" entry,
+// else -1 (not mentioned). NULL is an absent header: -1
+int http_headers_list_q(const char *list, const char *token) {
+    if (list == NULL) {
+        return -1;
+    }
+    size_t token_len = strlen(token);
+    int star = -1;
+    const char *p = list;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        const char *entry = p;
+        while (*p != '\0' && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') {
+            p++;
+        }
+        size_t entry_len = (size_t)(p - entry);
+        int q = 1000;
+        while (*p != '\0' && *p != ',') {
+            if (*p++ != ';') {
+                continue;
+            }
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            if ((*p == 'q' || *p == 'Q') && p[1] == '=') {
+                q = accept_parse_q(p + 2);
+            }
+        }
+        if (entry_len == token_len && strncasecmp(entry, token, token_len) == 0) {
+            return q;
+        }
+        if (entry_len == 1 && *entry == '*') {
+            star = q;
+        }
+    }
+    return star;
+}
+
+// Requests received so far on the connection of the request being handled
+uint16_t http_headers_request_count(void) {
+    return conn_current ? conn_current->requests : 0;
+}
+
+// Path of the request being handled (no query string), NULL when it was not
+// captured (too long, or the request line was not followed)
+const char *http_headers_request_path(void) {
+    return hdr.path_state == PATH_DONE && hdr.path_len > 0 ? hdr.path : NULL;
+}
+
+// Admission class of the last request on a connection and the send buffer
+// position when it arrived; false when no request was seen on it
+bool http_headers_conn_request(const struct tcp_pcb *pcb, uint8_t *cls, u32_t *snd_lbb) {
+    for (int i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+        if (conns[i].pcb == pcb) {
+            if (conns[i].remote_port != pcb->remote_port || conns[i].requests == 0) {
+                return false;
+            }
+            *cls = conns[i].cls;
+            *snd_lbb = conns[i].snd_lbb;
+            return true;
+        }
+    }
+    return false;
+}
+
+// time_us_32() when the first segment of the request being handled arrived
+uint32_t http_headers_request_start_us(void) {
+    return conn_current ? conn_current->start_us : time_us_32();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file    http_headers.h
+ * @brief   Captura dos cabeçalhos das requisições do httpd do lwIP
+ * @details O httpd do lwIP não repassa os cabeçalhos da requisição para
+ *          fs_open_custom() nem para os CGIs. Este módulo lê os segmentos
+ *          TCP destinados à porta do httpd pelo hook
+ *          LWIP_HOOK_TCP_INPACKET_PCB (ver lwip_hooks.h), que roda no
+ *          tcp_input imediatamente antes do callback de recepção do httpd,
+ *          e guarda o valor dos poucos cabeçalhos que interessam.
+ *
+ *          O parser é incremental e guarda o estado de uma conexão por vez:
+ *          um cabeçalho dividido entre dois segmentos da mesma conexão é
+ *          reconhecido, mas se outra conexão enviar dados no meio, a captura
+ *          da primeira recomeça do zero no próximo pedido.
+ *
+ *          Também conta os pedidos de cada conexão, para o limite de
+ *          pedidos por conexão persistente (http_keepalive.h), e guarda o
+ *          caminho e o instante de chegada do pedido, para as métricas por
+ *          URI (http_metrics.h). A classe do último pedido de cada conexão
+ *          (pelo método e pelo caminho) fica na mesma tabela, para a
+ *          admissão de conexões (http_admission.h).
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_HEADERS_H
+#define HTTP_HEADERS_H
+
+#include "pico/stdlib.h"
+#include "lwip/err.h"
+
+struct tcp_pcb;
+struct pbuf;
+
+// Cabeçalhos capturados
+typedef enum {
+    HTTP_HDR_IF_NONE_MATCH = 0,
+    HTTP_HDR_ACCEPT_ENCODING,
+    HTTP_HDR_ACCEPT,
+    HTTP_HDR_PREFER,
+    HTTP_HDR_COUNT
+} http_header_id_t;
+
+// Maior nome de cabeçalho comparado (nomes maiores são ignorados)
+#define HTTP_HEADERS_NAME_MAX   24
+
+// Maior valor guardado (incluindo o terminador); o resto é descartado
+#define HTTP_HEADERS_VALUE_MAX  64
+
+// Maior caminho da linha de requisição guardado (sem a query, incluindo o
+// terminador); caminhos maiores não são guardados
+#define HTTP_HEADERS_PATH_MAX   32
+
+// Funções públicas
+err_t http_headers_inpacket(struct tcp_pcb *pcb, struct pbuf *p);
+const char *http_headers_get(http_header_id_t id);
+int http_headers_list_q(const char *list, const char *token);
+uint16_t http_headers_request_count(void);
+const char *http_headers_request_path(void);
+uint32_t http_headers_request_start_us(void);
+bool http_headers_conn_request(const struct tcp_pcb *pcb, uint8_t *cls, u32_t *snd_lbb);
+
+#endif // HTTP_HEADERS_H
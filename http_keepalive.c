@@ -0,0 +1,93 @@
+/**
+ * @file    http_keepalive.c
+ * @brief   Conexões persistentes (HTTP/1.1 keep-alive) do httpd do lwIP
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "lwip/opt.h"
+
+#include "http_keepalive.h"
+#include "http_headers.h"
+
+#if !LWIP_HTTPD_SUPPORT_11_KEEPALIVE
+#error "http_keepalive.c needs LWIP_HTTPD_SUPPORT_11_KEEPALIVE (see lwipopts.h)"
+#endif
+#if !LWIP_HTTPD_DYNAMIC_FILE_READ || !LWIP_HTTPD_FS_ASYNC_READ
+#error "http_keepalive.c needs LWIP_HTTPD_DYNAMIC_FILE_READ and LWIP_HTTPD_FS_ASYNC_READ (see lwipopts.h)"
+#endif
+
+// True while the connection of the request being handled is under the cap
+bool http_keepalive_allowed(void) {
+    return http_headers_request_count() < HTTP_KEEPALIVE_MAX_REQUESTS;
+}
+
+// Flags for a response rendered in fs_open_custom() with its full header
+u8_t http_keepalive_flags(void) {
+    return FS_FILE_FLAGS_HEADER_INCLUDED | (http_keepalive_allowed() ? FS_FILE_FLAGS_HEADER_PERSISTENT : 0);
+}
+
+const char *http_keepalive_header(void) {
+    return http_keepalive_allowed() ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+}
+
+// Last request allowed on the connection of an embedded file: the same
+// response with "Connection: close" and without
+// FS_FILE_FLAGS_HEADER_PERSISTENT, so httpd closes once it has been sent.
+// Pulled through http_keepalive_read(); pextension points at the entry
+int http_keepalive_serve_last(struct fs_file *file, const http_keepalive_file_t *k) {
+    memset(file, 0, sizeof(struct fs_file));
+    file->data = NULL;
+    file->len = k->header_len + k->body_len;
+    file->index = 0;
+    file->flags = FS_FILE_FLAGS_HEADER_INCLUDED | FS_FILE_FLAGS_HEADER_HTTPVER_1_1;
+    file->pextension = (void *)k;
+    return 1;
+}
+
+int http_keepalive_open_last(struct fs_file *file, const char *name) {
+    if (http_keepalive_allowed()) {
+        return 0;
+    }
+    for (uint16_t i = 0; i < http_keepalive_file_count; i++) {
+        const http_keepalive_file_t *k = &http_keepalive_files[i];
+        if (strcmp(k->name, name) == 0) {
+            return http_keepalive_serve_last(file, k); // first entry: the fsdata encoding
+        }
+    }
+    return 0; // SSI pages already say "Connection: close"
+}
+
+bool http_keepalive_owns(const struct fs_file *file) {
+    const http_keepalive_file_t *k = (const http_keepalive_file_t *)file->pextension;
+    return k >= &http_keepalive_files[0] && k < &http_keepalive_files[http_keepalive_file_count];
+}
+
+// Header first, then the body straight from the fsdata entry
+int http_keepalive_read(struct fs_file *file, char *buffer, int count) {
+    const http_keepalive_file_t *k = (const http_keepalive_file_t *)file->pextension;
+    int copied = 0;
+    while (copied < count && file->index < file->len) {
+        const char *src;
+        int n;
+        if (file->index < k->header_len) {
+            src = k->header + file->index;
+            n = k->header_len - file->index;
+        } else {
+            src = (const char *)k->body + (file->index - k->header_len);
+            n = file->len - file->index;
+        }
+        if (n > count - copied) {
+            n = count - copied;
+        }
+        memcpy(buffer + copied, src, n);
+        copied += n;
+        file->index += n;
+    }
+    return copied > 0 ? copied : FS_READ_EOF;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file    http_keepalive.h
+ * @brief   Conexões persistentes (HTTP/1.1 keep-alive) do httpd do lwIP
+ * @details Com LWIP_HTTPD_SUPPORT_11_KEEPALIVE o httpd mantém a conexão
+ *          aberta depois da resposta quando o pedido traz "Connection:
+ *          keep-alive" e o arquivo tem cabeçalho completo, com
+ *          Content-Length (flag FS_FILE_FLAGS_HEADER_PERSISTENT). Os arquivos
+ *          estáticos do fsdata, as respostas JSON, os 204 e os 304 atendem
+ *          a essa condição. As páginas com SSI não têm tamanho conhecido
+ *          antes do envio e saem com "Connection: close".
+ *
+ *          A conexão ociosa é fechada pelo poll do httpd depois de
+ *          HTTP_KEEPALIVE_IDLE_S (ver lwipopts.h). Depois de
+ *          HTTP_KEEPALIVE_MAX_REQUESTS pedidos, a resposta é entregue sem a
+ *          flag persistente e com "Connection: close", e o httpd fecha a
+ *          conexão ao terminar. Para os arquivos estáticos esse cabeçalho
+ *          vem de http_keepalive_files (gerada por tools/makefsdata.py) e o
+ *          corpo é lido da entrada do fsdata por fs_read_custom(), com
+ *          cópia: só o último pedido de cada conexão paga por ela.
+ *
+ *          Pipelining não é suportado pelo httpd do lwIP: dados que chegam
+ *          enquanto uma resposta é enviada são descartados. Os navegadores
+ *          não usam pipelining, e o app.js faz um pedido por vez em cada
+ *          conexão.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_KEEPALIVE_H
+#define HTTP_KEEPALIVE_H
+
+#include "pico/stdlib.h"
+#include "lwip/apps/fs.h"
+
+struct fsdata_file;
+
+typedef struct {
+    const char *name;               // URI do arquivo no fsdata
+    const char *header;             // Cabeçalho com "Connection: close"
+    uint16_t header_len;
+    const uint8_t *body;            // Corpo na entrada do fsdata
+    uint32_t body_len;
+} http_keepalive_file_t;
+
+// Tabela gerada junto com o fsdata (pico_fsdata.inc)
+extern const http_keepalive_file_t http_keepalive_files[];
+extern const uint16_t http_keepalive_file_count;
+
+// Abrem um arquivo do fsdata com as flags alteradas (geradas em pico_fsdata.inc)
+int http_fsdata_open(struct fs_file *file, const char *name, u8_t clear_flags);
+int http_fsdata_open_file(struct fs_file *file, const struct fsdata_file *f, u8_t clear_flags);
+
+// Funções públicas
+bool http_keepalive_allowed(void);
+u8_t http_keepalive_flags(void);
+const char *http_keepalive_header(void);
+int http_keepalive_open_last(struct fs_file *file, const char *name);
+int http_keepalive_serve_last(struct fs_file *file, const http_keepalive_file_t *k);
+bool http_keepalive_owns(const struct fs_file *file);
+int http_keepalive_read(struct fs_file *file, char *buffer, int count);
+
+#endif // HTTP_KEEPALIVE_H
@@ -0,0 +1,482 @@
+/**
+ * @file    http_metrics.c
+ * @brief   Métricas no formato de texto do Prometheus (/metrics)
+ * @details Os contadores por URI são atualizados pelos ganchos
+ *          fs_state_init()/fs_state_free() do httpd (LWIP_HTTPD_FILE_STATE),
+ *          chamados no contexto do lwIP a cada arquivo aberto e fechado.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/sync.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+
+#include "http_metrics.h"
+#include "http_admission.h"
+#include "http_headers.h"
+#include "http_route.h"
+#include "http_sse.h"
+
+#if !LWIP_HTTPD_FILE_STATE
+#error "http_metrics.c needs LWIP_HTTPD_FILE_STATE (see lwipopts.h)"
+#endif
+#if !MEM_STATS || !MEMP_STATS
+#error "http_metrics.c needs MEM_STATS and MEMP_STATS (see lwipopts.h)"
+#endif
+
+// Longest line (or group of lines) rendered at once
+#define METRICS_LINE_MAX    160
+
+// Upper bounds of the latency histogram, in microseconds; one more bucket
+// (+Inf) counts the rest
+static const uint32_t bucket_us[] = { 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000 };
+static const char *const bucket_le[] = { "0.001", "0.002", "0.005", "0.01", "0.02", "0.05", "0.1", "0.2", "0.5",
+                                         "1", "+Inf" };
+#define METRICS_BUCKETS     (sizeof(bucket_us) / sizeof(bucket_us[0]))
+
+// Pool names, in the order of lwip_stats.memp[]
+static const char *const memp_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+
+static const char *const op_names[HTTP_METRICS_OP_COUNT] = {
+    [HTTP_METRICS_OP_NP_WRITE] = "np_write",
+    [HTTP_METRICS_OP_OLED_RENDER] = "oled_render",
+    [HTTP_METRICS_OP_BUZZER_PLAY] = "buzzer_play",
+};
+
+typedef struct {
+    char uri[HTTP_METRICS_URI_MAX];
+    uint32_t requests;
+    uint32_t timed;                         // requests in the histogram
+    uint64_t sum_us;
+    uint32_t buckets[METRICS_BUCKETS + 1];  // not cumulative; made so when rendered
+} metrics_uri_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t max_us;
+    uint64_t sum_us;
+} metrics_op_t;
+
+// Request in flight: the file state handed to httpd
+typedef struct {
+    metrics_uri_t *uri;                     // NULL = free
+    uint32_t start_us;
+} metrics_req_t;
+
+typedef struct {
+    bool used;
+    bool rssi_ok;
+    uint8_t section;
+    uint16_t item;                          // Position inside the section
+    uint8_t line_len;
+    uint8_t line_off;                       // Bytes of line[] already handed to httpd
+    int32_t rssi;
+    char line[METRICS_LINE_MAX];
+} metrics_reader_t;
+
+static metrics_uri_t uris[HTTP_METRICS_URI_SLOTS + 1] = {
+    [HTTP_METRICS_URI_SLOTS] = { .uri = "other" },
+};
+static uint8_t uri_count = 0;
+static metrics_op_t ops[HTTP_METRICS_OP_COUNT];
+// One open file per connection
+static metrics_req_t reqs[MEMP_NUM_TCP_PCB];
+static metrics_reader_t readers[HTTP_METRICS_READERS];
+
+static const char metrics_header[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+static const char metrics_busy[] =
+    "HTTP/1.0 503 Service Unavailable\r\n"
+    "Content-Type: text/plain\r\n"
+    "Retry-After: 5\r\n"
+    "\r\n"
+    "Too many metrics readers\n";
+
+// Called from the main loop and from the lwIP context; the 64-bit sum is
+// not atomic on the M0+, so the update can't be split by the reader
+void http_metrics_op(http_metrics_op_t op, uint32_t start_us) {
+    uint32_t us = time_us_32() - start_us;
+    metrics_op_t *m = &ops[op];
+    uint32_t irq = save_and_disable_interrupts();
+    m->calls++;
+    m->sum_us += us;
+    if (us > m->max_us) {
+        m->max_us = us;
+    }
+    restore_interrupts(irq);
+}
+
+// ===== Contadores por URI =====
+
+// The CGI route when the request path is one, else the file being served
+static metrics_uri_t *metrics_uri_for(const char *name) {
+    const char *path = http_headers_request_path();
+    const char *label = (path != NULL && http_route_find(path) >= 0) ? path : name;
+    for (int i = 0; i < uri_count; i++) {
+        if (strcmp(uris[i].uri, label) == 0) {
+            return &uris[i];
+        }
+    }
+    if (uri_count < HTTP_METRICS_URI_SLOTS && strlen(label) < HTTP_METRICS_URI_MAX) {
+        metrics_uri_t *u = &uris[uri_count++];
+        strcpy(u->uri, label);
+        return u;
+    }
+    return &uris[HTTP_METRICS_URI_SLOTS];
+}
+
+// Called by fs_open() after every successful open
+void *fs_state_init(struct fs_file *file, const char *name) {
+    (void)file;
+    metrics_uri_t *u = metrics_uri_for(name);
+    u->requests++;
+    if (strcmp(name, HTTP_SSE_URI) == 0) {
+        return NULL; // lasts as long as the client stays: no latency
+    }
+    for (int i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+        if (reqs[i].uri == NULL) {
+            reqs[i].uri = u;
+            reqs[i].start_us = http_headers_request_start_us();
+            return &reqs[i];
+        }
+    }
+    return NULL;
+}
+
+// Called by fs_close() once the response has been handed to TCP
+void fs_state_free(struct fs_file *file, void *state) {
+    (void)file;
+    metrics_req_t *r = (metrics_req_t *)state;
+    if (r == NULL) {
+        return;
+    }
+    uint32_t us = time_us_32() - r->start_us;
+    metrics_uri_t *u = r->uri;
+    r->uri = NULL;
+
+    uint b = 0;
+    while (b < METRICS_BUCKETS && us > bucket_us[b]) {
+        b++;
+    }
+    u->buckets[b]++;
+    u->timed++;
+    u->sum_us += us;
+}
+
+// ===== Texto do /metrics =====
+
+// Render one item of a section: its length, 0 at the end of the section,
+// METRICS_SKIP for an item with nothing to show
+typedef int (*metrics_section_fn)(const metrics_reader_t *r, uint16_t item, char *buf, size_t len);
+
+#define METRICS_SKIP        (-1)
+
+static int section_header(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return item == 0 ? snprintf(buf, len, "%s", metrics_header) : 0;
+}
+
+static int section_mem(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    const struct stats_mem *m = &lwip_stats.mem;
+    switch (item) {
+        case 0:
+            return snprintf(buf, len, "# TYPE lwip_mem_used_bytes gauge\nlwip_mem_used_bytes %lu\n",
+                            (unsigned long)m->used);
+        case 1:
+            return snprintf(buf, len, "# TYPE lwip_mem_max_bytes gauge\nlwip_mem_max_bytes %lu\n",
+                            (unsigned long)m->max);
+        case 2:
+            return snprintf(buf, len, "# TYPE lwip_mem_errors_total counter\nlwip_mem_errors_total %lu\n",
+                            (unsigned long)m->err);
+        case 3:
+            return snprintf(buf, len, "# TYPE lwip_mem_size_bytes gauge\nlwip_mem_size_bytes %lu\n",
+                            (unsigned long)m->avail);
+        default:
+            return 0;
+    }
+}
+
+// One family per field of the pool stats: the TYPE line, then one sample per pool
+static int memp_family(uint16_t item, char *buf, size_t len, const char *metric, const char *type, int field) {
+    if (item == 0) {
+        return snprintf(buf, len, "# TYPE %s %s\n", metric, type);
+    }
+    if (item > MEMP_MAX) {
+        return 0;
+    }
+    const struct stats_mem *m = lwip_stats.memp[item - 1];
+    unsigned long value;
+    switch (field) {
+        case 0: value = m->used; break;
+        case 1: value = m->max; break;
+        case 2: value = m->err; break;
+        case 3: value = m->avail; break;
+        default: value = memp_pools[item - 1]->size; break;
+    }
+    return snprintf(buf, len, "%s{pool=\"%s\"} %lu\n", metric, memp_names[item - 1], value);
+}
+
+static int section_memp_used(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return memp_family(item, buf, len, "lwip_memp_used", "gauge", 0);
+}
+
+static int section_memp_max(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return memp_family(item, buf, len, "lwip_memp_max", "gauge", 1);
+}
+
+static int section_memp_err(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return memp_family(item, buf, len, "lwip_memp_errors_total", "counter", 2);
+}
+
+// Pool sizes, for tools/lwip_profile.py: elements and bytes per element
+static int section_memp_size(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return memp_family(item, buf, len, "lwip_memp_size", "gauge", 3);
+}
+
+static int section_memp_element(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    return memp_family(item, buf, len, "lwip_memp_element_bytes", "gauge", 4);
+}
+
+// Learned URIs, then "other"
+static const metrics_uri_t *metrics_uri_at(uint16_t index) {
+    if (index < uri_count) {
+        return &uris[index];
+    }
+    return index == uri_count ? &uris[HTTP_METRICS_URI_SLOTS] : NULL;
+}
+
+static int section_requests(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    if (item == 0) {
+        return snprintf(buf, len, "# TYPE http_requests_total counter\n");
+    }
+    const metrics_uri_t *u = metrics_uri_at(item - 1);
+    if (u == NULL) {
+        return 0;
+    }
+    return snprintf(buf, len, "http_requests_total{uri=\"%s\"} %lu\n", u->uri, (unsigned long)u->requests);
+}
+
+static int section_latency(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    if (item == 0) {
+        return snprintf(buf, len, "# TYPE http_request_duration_seconds histogram\n");
+    }
+    // Per URI: every bucket, then _sum and _count
+    const uint16_t lines = METRICS_BUCKETS + 3;
+    const metrics_uri_t *u = metrics_uri_at((item - 1) / lines);
+    uint16_t line = (item - 1) % lines;
+    if (u == NULL) {
+        return 0;
+    }
+    if (u->timed == 0) {
+        return METRICS_SKIP; // streams only, or nothing finished yet
+    }
+    if (line <= METRICS_BUCKETS) {
+        unsigned long cumulative = 0;
+        for (uint16_t b = 0; b <= line; b++) {
+            cumulative += u->buckets[b];
+        }
+        return snprintf(buf, len, "http_request_duration_seconds_bucket{uri=\"%s\",le=\"%s\"} %lu\n",
+                        u->uri, bucket_le[line], cumulative);
+    }
+    if (line == METRICS_BUCKETS + 1) {
+        return snprintf(buf, len, "http_request_duration_seconds_sum{uri=\"%s\"} %lu.%06lu\n", u->uri,
+                        (unsigned long)(u->sum_us / 1000000), (unsigned long)(u->sum_us % 1000000));
+    }
+    return snprintf(buf, len, "http_request_duration_seconds_count{uri=\"%s\"} %lu\n", u->uri,
+                    (unsigned long)u->timed);
+}
+
+// Three families (calls, total time, worst time), one sample per operation
+static int section_ops(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    const uint16_t lines = HTTP_METRICS_OP_COUNT + 1;
+    uint16_t family = item / lines;
+    uint16_t line = item % lines;
+    static const char *const families[][2] = {
+        { "bitdoglab_op_calls_total", "counter" },
+        { "bitdoglab_op_seconds_total", "counter" },
+        { "bitdoglab_op_max_seconds", "gauge" },
+    };
+    if (family >= LWIP_ARRAYSIZE(families)) {
+        return 0;
+    }
+    const char *metric = families[family][0];
+    if (line == 0) {
+        return snprintf(buf, len, "# TYPE %s %s\n", metric, families[family][1]);
+    }
+    const metrics_op_t *m = &ops[line - 1];
+    const char *op = op_names[line - 1];
+    switch (family) {
+        case 0:
+            return snprintf(buf, len, "%s{op=\"%s\"} %lu\n", metric, op, (unsigned long)m->calls);
+        case 1:
+            return snprintf(buf, len, "%s{op=\"%s\"} %lu.%06lu\n", metric, op,
+                            (unsigned long)(m->sum_us / 1000000), (unsigned long)(m->sum_us % 1000000));
+        default:
+            return snprintf(buf, len, "%s{op=\"%s\"} %lu.%06lu\n", metric, op,
+                            (unsigned long)(m->max_us / 1000000), (unsigned long)(m->max_us % 1000000));
+    }
+}
+
+// Evictions per class, then refused SYNs
+static int section_admission(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    (void)r;
+    http_admission_stats_t a;
+    http_admission_get_stats(&a);
+    const uint16_t classes = LWIP_ARRAYSIZE(a.evicted);
+    if (item == 0) {
+        return snprintf(buf, len, "# TYPE http_admission_evictions_total counter\n");
+    }
+    if (item <= classes) {
+        return snprintf(buf, len, "http_admission_evictions_total{class=\"%s\"} %lu\n",
+                        http_admission_class_name((http_admission_class_t)(item - 1)),
+                        (unsigned long)a.evicted[item - 1]);
+    }
+    if (item == classes + 1) {
+        return snprintf(buf, len, "# TYPE http_admission_refusals_total counter\nhttp_admission_refusals_total %lu\n",
+                        (unsigned long)a.refused);
+    }
+    return 0;
+}
+
+static int section_wifi(const metrics_reader_t *r, uint16_t item, char *buf, size_t len) {
+    if (item != 0 || !r->rssi_ok) {
+        return 0;
+    }
+    return snprintf(buf, len, "# TYPE wifi_rssi_dbm gauge\nwifi_rssi_dbm %ld\n", (long)r->rssi);
+}
+
+static const metrics_section_fn sections[] = {
+    section_header,
+    section_mem,
+    section_memp_used,
+    section_memp_max,
+    section_memp_err,
+    section_memp_size,
+    section_memp_element,
+    section_requests,
+    section_latency,
+    section_ops,
+    section_admission,
+    section_wifi,
+};
+
+// Render the next line into r->line; false at the end of the document
+static bool metrics_next_line(metrics_reader_t *r) {
+    while (r->section < LWIP_ARRAYSIZE(sections)) {
+        int n = sections[r->section](r, r->item, r->line, sizeof(r->line));
+        if (n == METRICS_SKIP) {
+            r->item++;
+            continue;
+        }
+        if (n > 0) {
+            r->item++;
+            r->line_len = (uint8_t)(n < (int)sizeof(r->line) ? n : (int)sizeof(r->line) - 1);
+            r->line_off = 0;
+            return true;
+        }
+        r->section++;
+        r->item = 0;
+    }
+    return false;
+}
+
+// ===== Ganchos do httpd =====
+
+bool http_metrics_open(struct fs_file *file, const char *name) {
+    if (strcmp(name, HTTP_METRICS_URI) != 0) {
+        return false;
+    }
+
+    memset(file, 0, sizeof(struct fs_file));
+    file->flags = FS_FILE_FLAGS_HEADER_INCLUDED;
+
+    metrics_reader_t *r = NULL;
+    for (int i = 0; i < HTTP_METRICS_READERS; i++) {
+        if (!readers[i].used) {
+            r = &readers[i];
+            break;
+        }
+    }
+    if (r == NULL) {
+        LOG_WARN("[METRICS] Limite de %d leitores atingido", HTTP_METRICS_READERS);
+        file->data = metrics_busy;
+        file->len = sizeof(metrics_busy) - 1;
+        file->index = file->len;
+        return true;
+    }
+
+    memset(r, 0, sizeof(*r));
+    r->used = true;
+    r->rssi_ok = cyw43_wifi_get_rssi(&cyw43_state, &r->rssi) == 0;
+
+    // Pulled through http_metrics_read(); index stays at 0 until EOF
+    file->data = NULL;
+    file->len = HTTP_METRICS_READ_CHUNK;
+    file->index = 0;
+    file->pextension = r;
+    return true;
+}
+
+bool http_metrics_owns(const struct fs_file *file) {
+    const metrics_reader_t *r = (const metrics_reader_t *)file->pextension;
+    return file->data == metrics_busy || (r >= &readers[0] && r < &readers[HTTP_METRICS_READERS]);
+}
+
+bool http_metrics_close(struct fs_file *file) {
+    if (!http_metrics_owns(file)) {
+        return false;
+    }
+    if (file->data != metrics_busy) {
+        ((metrics_reader_t *)file->pextension)->used = false;
+        file->pextension = NULL;
+    }
+    return true;
+}
+
+int http_metrics_read(struct fs_file *file, char *buffer, int count) {
+    metrics_reader_t *r = (metrics_reader_t *)file->pextension;
+    int copied = 0;
+    while (copied < count) {
+        if (r->line_off == r->line_len && !metrics_next_line(r)) {
+            break;
+        }
+        int n = r->line_len - r->line_off;
+        if (n > count - copied) {
+            n = count - copied;
+        }
+        memcpy(buffer + copied, r->line + r->line_off, n);
+        copied += n;
+        r->line_off += n;
+    }
+    return copied > 0 ? copied : FS_READ_EOF;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file    http_metrics.h
+ * @brief   Métricas no formato de texto do Prometheus (/metrics)
+ * @details Reúne num endpoint de texto:
+ *          - uso, máximo e falhas de alocação do heap e de cada pool do lwIP
+ *            (MEM_STATS/MEMP_STATS, ligados também em produção), com o
+ *            tamanho configurado de cada um (lido por tools/lwip_profile.py);
+ *          - pedidos e histograma de latência por URI, da chegada do
+ *            primeiro segmento até o httpd fechar o arquivo da resposta;
+ *          - chamadas, tempo total e pior tempo das operações de periférico
+ *            (envio da matriz de LEDs, render do OLED, buzzer);
+ *          - despejos por classe e recusas da admissão de conexões
+ *            (http_admission.h);
+ *          - RSSI do WiFi, lido a cada coleta.
+ *
+ *          Os contadores são fixos e estáticos; cada atualização é um
+ *          punhado de somas. A URI de um pedido é a rota do CGI quando o
+ *          caminho é uma rota (http_routes.def), senão o arquivo servido
+ *          (o 404 conta como "/404.html"). As primeiras
+ *          HTTP_METRICS_URI_SLOTS URIs distintas ganham contadores próprios;
+ *          as demais somam em "other". O stream /api/events conta pedidos
+ *          mas não entra no histograma.
+ *
+ *          A resposta é gerada linha a linha durante o envio (leitura
+ *          assíncrona do httpd, como o stream SSE), sem buffer do tamanho do
+ *          documento, e sai com "Connection: close".
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_METRICS_H
+#define HTTP_METRICS_H
+
+#include "pico/stdlib.h"
+#include "lwip/apps/fs.h"
+
+#define HTTP_METRICS_URI            "/metrics"
+
+// URIs com contadores próprios (arquivos do fsdata, APIs e rotas de CGI)
+#ifndef HTTP_METRICS_URI_SLOTS
+#define HTTP_METRICS_URI_SLOTS      20
+#endif
+
+// Maior URI guardada (incluindo o terminador)
+#define HTTP_METRICS_URI_MAX        24
+
+// Coletas simultâneas de /metrics
+#define HTTP_METRICS_READERS        2
+
+// Bytes entregues ao httpd por leitura
+#define HTTP_METRICS_READ_CHUNK     512
+
+// Operações de periférico cronometradas
+typedef enum {
+    HTTP_METRICS_OP_NP_WRITE = 0,   // Envio da matriz de LEDs (npWriteAsync)
+    HTTP_METRICS_OP_OLED_RENDER,    // Render do OLED pelo I2C
+    HTTP_METRICS_OP_BUZZER_PLAY,    // Nota enfileirada ou parada do buzzer
+    HTTP_METRICS_OP_COUNT
+} http_metrics_op_t;
+
+// Funções públicas
+// Pode ser chamada do laço principal ou do contexto do lwIP: a atualização
+// roda com as interrupções desligadas, e a leitura em /metrics não trava nada.
+void http_metrics_op(http_metrics_op_t op, uint32_t start_us);
+
+// Ganchos chamados pelos fs_*_custom() do httpd
+bool http_metrics_open(struct fs_file *file, const char *name);
+bool http_metrics_close(struct fs_file *file);
+bool http_metrics_owns(const struct fs_file *file);
+int http_metrics_read(struct fs_file *file, char *buffer, int count);
+
+#endif // HTTP_METRICS_H
@@ -0,0 +1,230 @@
+/**
+ * @file    http_route.c
+ * @brief   Despacho de rotas e parâmetros dos CGIs por hash perfeito
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "http_route.h"
+
+#define HTTP_ROUTE_NONE     0xFF
+#define FNV_PRIME           16777619u
+
+// FNV-1a with the seed picked by the generator as offset basis; the final
+// fold brings the high bits (where the seed shows up) into the slot mask.
+// Must match fnv1a() in tools/gen_http_routes.py
+static uint32_t http_route_hash(uint32_t seed, const char *s, size_t len) {
+    uint32_t h = seed;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= FNV_PRIME;
+    }
+    return h ^ (h >> 16);
+}
+
+int http_route_find(const char *uri) {
+    size_t len = strcspn(uri, "?");
+    uint8_t id = http_route_uri_slots[http_route_hash(HTTP_ROUTE_URI_SEED, uri, len) & (HTTP_ROUTE_URI_SLOTS - 1)];
+    if (id == HTTP_ROUTE_NONE || http_routes[id].uri_len != len || memcmp(http_routes[id].uri, uri, len) != 0) {
+        return -1;
+    }
+    return id;
+}
+
+int http_route_key_find(const char *key, size_t len) {
+    uint8_t id = http_route_key_slots[http_route_hash(HTTP_ROUTE_KEY_SEED, key, len) & (HTTP_ROUTE_KEY_SLOTS - 1)];
+    if (id == HTTP_ROUTE_NONE || strncmp(http_route_key_names[id], key, len) != 0 ||
+        http_route_key_names[id][len] != '\0') {
+        return -1;
+    }
+    return id;
+}
+
+// Index of an enum value, -1 when it is not one of the names
+static int route_enum_find(const http_param_desc_t *d, const char *value, size_t len) {
+    uint8_t i = d->name_slots[http_route_hash(d->name_seed, value, len) & (d->name_slot_count - 1)];
+    if (i == HTTP_ROUTE_NONE || strcmp(d->names[i], value) != 0) {
+        return -1;
+    }
+    return i;
+}
+
+// Descriptor of a key for the current route, NULL when the route ignores it
+static void route_resolve(http_route_req_t *req, const char *key) {
+    int id = http_route_key_find(key, strlen(key));
+    uint8_t index = (id < 0) ? HTTP_ROUTE_NONE : req->route->param_map[id];
+    req->param = (index == HTTP_ROUTE_NONE) ? NULL : &req->route->params[index];
+}
+
+static void route_emit(http_route_req_t *req, http_value_t *v) {
+    v->key = req->param->key;
+    v->type = req->param->type;
+    req->on_value(req->arg, v);
+}
+
+static void route_emit_end(http_route_req_t *req) {
+    http_value_t v = { .end = true };
+    route_emit(req, &v);
+}
+
+static void route_emit_color(http_route_req_t *req) {
+    http_value_t v = { .color = req->color };
+    route_emit(req, &v);
+    req->color = 0;
+    req->digits = 0;
+}
+
+static int route_hex(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decimal with saturation at the descriptor's maximum; false if no digits
+static bool route_parse_num(const char *s, uint32_t max, uint32_t *out) {
+    uint64_t n = 0;
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+    for (; *s >= '0' && *s <= '9'; s++) {
+        n = n * 10 + (*s - '0');
+        if (n > max) {
+            n = max;
+        }
+    }
+    *out = (uint32_t)n;
+    return true;
+}
+
+static http_form_mode_t route_form_key(void *arg, const char *key) {
+    http_route_req_t *req = (http_route_req_t *)arg;
+    route_resolve(req, key);
+    req->key_done = (req->param != NULL);
+    if (req->param == NULL) {
+        return HTTP_FORM_SKIP; // no callback for this pair
+    }
+    if (req->param->type == HTTP_PARAM_HEXLIST || req->param->type == HTTP_PARAM_STREAM) {
+        req->color = 0;
+        req->digits = 0;
+        return HTTP_FORM_STREAM;
+    }
+    return HTTP_FORM_BUFFER;
+}
+
+static void route_form_chunk(void *arg, const char *key, const char *data, size_t len) {
+    http_route_req_t *req = (http_route_req_t *)arg;
+    req->key_done = false;
+    if (req->param->type == HTTP_PARAM_STREAM) {
+        http_value_t v = { .end = (data == NULL), .chunk = { data, len } };
+        route_emit(req, &v);
+        return;
+    }
+
+    if (data == NULL) {
+        if (req->digits > 0) {
+            route_emit_color(req);
+        }
+        route_emit_end(req);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] == ',') {
+            route_emit_color(req); // an empty entry is black
+            continue;
+        }
+        int v = route_hex(data[i]);
+        if (v >= 0 && req->digits < 6) {
+            req->color = req->color << 4 | v;
+            req->digits++;
+        }
+    }
+}
+
+static void route_form_pair(void *arg, const char *key, char *value, size_t len) {
+    http_route_req_t *req = (http_route_req_t *)arg;
+    bool key_done = req->key_done;
+    req->key_done = false;
+    if (value == NULL) {
+        return; // overflowed: the next pair must not reuse this descriptor
+    }
+    if (!key_done) {
+        route_resolve(req, key); // key without '='
+    }
+    if (req->param == NULL) {
+        return;
+    }
+
+    const http_param_desc_t *d = req->param;
+    http_value_t v = { 0 };
+    switch (d->type) {
+        case HTTP_PARAM_U8:
+        case HTTP_PARAM_U16:
+        case HTTP_PARAM_U32:
+            if (!route_parse_num(value, d->max, &v.num)) {
+                return;
+            }
+            break;
+        case HTTP_PARAM_ENUM: {
+            int i = route_enum_find(d, value, len);
+            if (i < 0) {
+                return;
+            }
+            v.num = (uint32_t)i;
+            break;
+        }
+        case HTTP_PARAM_TEXT:
+            if (len > d->max) {
+                len = d->max;
+                value[len] = '\0';
+            }
+            v.text.str = value;
+            v.text.len = len;
+            break;
+        case HTTP_PARAM_FLAG:
+            v.num = 1;
+            break;
+        default:
+            v.end = true; // streamed key given without '=': empty value
+            break;
+    }
+    route_emit(req, &v);
+}
+
+void http_route_begin(http_route_req_t *req, uint route, http_route_value_fn on_value, void *arg) {
+    req->route = &http_routes[route];
+    req->param = NULL;
+    req->key_done = false;
+    req->digits = 0;
+    req->color = 0;
+    req->on_value = on_value;
+    req->arg = arg;
+    http_form_init(&req->form, route_form_pair, req);
+    http_form_set_stream(&req->form, route_form_key, route_form_chunk);
+}
+
+void http_route_feed_pbuf(http_route_req_t *req, const struct pbuf *p) {
+    http_form_feed_pbuf(&req->form, p);
+}
+
+// httpd has already split the query at '&' and '=' but left the values
+// encoded; re-joining them lets GET share the POST tokenizer and decoding
+void http_route_feed_query(http_route_req_t *req, int count, char *names[], char *values[]) {
+    for (int i = 0; i < count; i++) {
+        http_form_feed(&req->form, names[i], strlen(names[i]));
+        if (values[i] != NULL) {
+            http_form_feed(&req->form, "=", 1);
+            http_form_feed(&req->form, values[i], strlen(values[i]));
+        }
+        http_form_feed(&req->form, "&", 1);
+    }
+}
+
+void http_route_finish(http_route_req_t *req) {
+    http_form_finish(&req->form);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file    http_route.h
+ * @brief   Despacho de rotas e parâmetros dos CGIs por hash perfeito
+ * @details As rotas e os parâmetros aceitos por cada uma são declarados em
+ *          http_routes.def; tools/gen_http_routes.py gera na compilação as
+ *          tabelas de hash perfeito (http_routes_gen.h/.c). Reconhecer uma
+ *          URI, uma chave ou o valor de um enum custa um hash e uma única
+ *          comparação, qualquer que seja o número de nomes.
+ *
+ *          Cada parâmetro tem um tipo (u8, u16, u32, enum, lista hex, texto,
+ *          flag ou stream) e o valor chega ao handler já decodificado. O
+ *          corpo de um POST e a query string de um GET passam pelo mesmo
+ *          tokenizador (http_form), então os dois caminhos têm o mesmo
+ *          comportamento.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_ROUTE_H
+#define HTTP_ROUTE_H
+
+#include "pico/stdlib.h"
+#include "lwip/pbuf.h"
+
+#include "http_form.h"
+#include "http_routes_gen.h"
+
+typedef enum {
+    HTTP_PARAM_U8 = 0,
+    HTTP_PARAM_U16,
+    HTTP_PARAM_U32,
+    HTTP_PARAM_ENUM,            // Índice do nome na lista do descritor
+    HTTP_PARAM_HEXLIST,         // "RRGGBB,RRGGBB,...", uma chamada por cor
+    HTTP_PARAM_TEXT,            // Texto decodificado e truncado
+    HTTP_PARAM_FLAG,            // Presença da chave
+    HTTP_PARAM_STREAM,          // Pedaços do valor, sem buffer
+} http_param_type_t;
+
+typedef struct {
+    uint8_t key;                // http_key_id_t
+    uint8_t type;               // http_param_type_t
+    uint32_t max;               // Números: saturação; texto: comprimento máximo
+    const char *const *names;   // Nomes do enum
+    uint8_t name_count;
+    uint32_t name_seed;         // Hash perfeito dos nomes do enum
+    const uint8_t *name_slots;
+    uint16_t name_slot_count;
+} http_param_desc_t;
+
+typedef struct {
+    const char *uri;
+    uint8_t uri_len;
+    const http_param_desc_t *params;
+    const uint8_t *param_map;   // http_key_id_t -> índice em params (0xFF = não aceito)
+} http_route_desc_t;
+
+// Valor decodificado entregue ao handler
+typedef struct {
+    uint8_t key;                // http_key_id_t
+    uint8_t type;               // http_param_type_t
+    bool end;                   // Hexlist/stream: fim do valor (sem dado nesta chamada)
+    union {
+        uint32_t num;           // u8/u16/u32, índice do enum, flag (1)
+        uint32_t color;         // Hexlist: 0xRRGGBB
+        struct {
+            char *str;          // Terminado em '\0'; pode ser alterado
+            size_t len;
+        } text;
+        struct {
+            const char *data;
+            size_t len;
+        } chunk;                // Stream
+    };
+} http_value_t;
+
+typedef void (*http_route_value_fn)(void *arg, const http_value_t *value);
+
+// Estado de uma requisição em andamento (um por conexão)
+typedef struct {
+    const http_route_desc_t *route;
+    const http_param_desc_t *param; // Descritor do valor atual (NULL = ignorado)
+    bool key_done;              // Chave do par atual já resolvida no '='
+    uint8_t digits;             // Hexlist: dígitos da cor atual
+    uint32_t color;
+    http_form_t form;
+    http_route_value_fn on_value;
+    void *arg;
+} http_route_req_t;
+
+// Tabelas geradas (http_routes_gen.c)
+extern const http_route_desc_t http_routes[HTTP_ROUTE_COUNT];
+extern const uint8_t http_route_uri_slots[HTTP_ROUTE_URI_SLOTS];
+extern const uint8_t http_route_key_slots[HTTP_ROUTE_KEY_SLOTS];
+extern const char *const http_route_key_names[HTTP_KEY_COUNT];
+
+// Funções públicas
+int http_route_find(const char *uri);
+int http_route_key_find(const char *key, size_t len);
+void http_route_begin(http_route_req_t *req, uint route, http_route_value_fn on_value, void *arg);
+void http_route_feed_pbuf(http_route_req_t *req, const struct pbuf *p);
+void http_route_feed_query(http_route_req_t *req, int count, char *names[], char *values[]);
+void http_route_finish(http_route_req_t *req);
+
+#endif // HTTP_ROUTE_H
@@ -0,0 +1,331 @@
+/**
+ * @file    http_sse.c
+ * @brief   Stream Server-Sent Events (/api/events) servido pelo httpd do lwIP
+ * @details Todo o código roda no contexto do lwIP (callbacks do httpd e
+ *          sys_timeout), portanto não há concorrência entre os assinantes.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/apps/httpd.h"
+#include "lwip/sys.h"
+#include "lwip/timeouts.h"
+
+#include "input_sampler.h"
+#include "http_sse.h"
+
+// The heartbeat must reach the client (and be ACKed) before httpd's poll
+// timer gives up on an idle connection (HTTPD_POLL_INTERVAL is in 500 ms ticks)
+#if HTTP_SSE_HEARTBEAT_MS >= (HTTPD_POLL_INTERVAL * HTTPD_MAX_RETRIES * 500)
+#error "HTTP_SSE_HEARTBEAT_MS must be shorter than the httpd idle timeout"
+#endif
+
+static const char sse_header[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-store\r\n"
+    "\r\n"
+    "retry: 2000\n\n";
+
+static const char sse_busy[] =
+    "HTTP/1.0 503 Service Unavailable\r\n"
+    "Content-Type: text/plain\r\n"
+    "Retry-After: 5\r\n"
+    "\r\n"
+    "Too many event streams\n";
+
+typedef struct {
+    char data[HTTP_SSE_EVENT_MAX];
+    uint8_t len;
+} sse_event_t;
+
+typedef struct {
+    bool used;
+    bool header_sent;               // The header is always the first queued entry
+    bool resync;                    // Queue overflowed: send a fresh "state" next
+    uint8_t head;
+    uint8_t count;
+    uint8_t offset;                 // Bytes of queue[head] already handed to httpd
+    sse_event_t queue[HTTP_SSE_QUEUE_LEN];
+    fs_wait_cb wait_cb;             // Set while httpd waits for data (FS_READ_DELAYED)
+    void *wait_arg;
+} sse_sub_t;
+
+static http_sse_config_t cfg;
+static sse_sub_t subs[HTTP_SSE_MAX_SUBSCRIBERS];
+static uint sub_count = 0;
+static uint32_t coalesced = 0;
+
+// Last values broadcast to every subscriber
+static input_snapshot_t last;
+static u32_t last_emit_ms;
+
+static int sse_format(sse_event_t *ev, const char *event, http_sse_render_fn render) {
+    int n = snprintf(ev->data, sizeof(ev->data), "event: %s\ndata: ", event);
+    int body = render(ev->data + n, sizeof(ev->data) - n - 2);
+    if (body < 0 || n + body + 2 >= (int)sizeof(ev->data)) {
+        return -1;
+    }
+    n += body;
+    ev->data[n++] = '\n';
+    ev->data[n++] = '\n';
+    ev->len = (uint8_t)n;
+    return n;
+}
+
+static void sse_push(sse_sub_t *s, const sse_event_t *ev) {
+    if (s->count >= HTTP_SSE_QUEUE_LEN) {
+        // Client fell behind: drop the backlog (keeping an entry already in
+        // flight or the unsent header) and coalesce into one "state" event
+        uint8_t keep = (s->offset > 0 || !s->header_sent) ? 1 : 0;
+        coalesced += s->count - keep;
+        s->count = keep;
+        s->resync = true;
+        return;
+    }
+    s->queue[(s->head + s->count) % HTTP_SSE_QUEUE_LEN] = *ev;
+    s->count++;
+}
+
+static void sse_wake(sse_sub_t *s) {
+    if (s->wait_cb) {
+        fs_wait_cb cb = s->wait_cb;
+        s->wait_cb = NULL;
+        cb(s->wait_arg); // httpd resumes sending from this connection
+    }
+}
+
+static void sse_broadcast(const sse_event_t *ev) {
+    for (int i = 0; i < HTTP_SSE_MAX_SUBSCRIBERS; i++) {
+        if (subs[i].used) {
+            sse_push(&subs[i], ev);
+        }
+    }
+    last_emit_ms = sys_now();
+}
+
+// Renderers for the change events, fed from the snapshot being compared
+static const input_snapshot_t *render_in;
+
+static int sse_render_btn(char *buf, size_t len) {
+    return snprintf(buf, len, "{\"btna\":%d,\"btnb\":%d,\"joybtn\":%d}",
+                    render_in->btn_a_pressed, render_in->btn_b_pressed, render_in->joy_btn_pressed);
+}
+
+static int sse_render_joy(char *buf, size_t len) {
+    return snprintf(buf, len, "{\"joyx\":%u,\"joyy\":%u}", render_in->joystick_x, render_in->joystick_y);
+}
+
+static int sse_render_temp(char *buf, size_t len) {
+    return snprintf(buf, len, "{\"temp\":%.1f}", render_in->temperature_c);
+}
+
+static void sse_tick(void *arg) {
+    (void)arg;
+    if (sub_count == 0) {
+        return; // last subscriber left: stop polling until the next one
+    }
+
+    input_snapshot_t in;
+    sse_event_t ev;
+    input_sampler_read(&in);
+    render_in = &in;
+
+    if (in.btn_a_pressed != last.btn_a_pressed || in.btn_b_pressed != last.btn_b_pressed ||
+        in.joy_btn_pressed != last.joy_btn_pressed) {
+        if (sse_format(&ev, "btn", sse_render_btn) > 0) {
+            sse_broadcast(&ev);
+        }
+        last.btn_a_pressed = in.btn_a_pressed;
+        last.btn_b_pressed = in.btn_b_pressed;
+        last.joy_btn_pressed = in.joy_btn_pressed;
+    }
+
+    int dx = (int)in.joystick_x - (int)last.joystick_x;
+    int dy = (int)in.joystick_y - (int)last.joystick_y;
+    if (abs(dx) > cfg.joy_deadband || abs(dy) > cfg.joy_deadband) {
+        if (sse_format(&ev, "joy", sse_render_joy) > 0) {
+            sse_broadcast(&ev);
+        }
+        last.joystick_x = in.joystick_x;
+        last.joystick_y = in.joystick_y;
+    }
+
+    float dt = in.temperature_c - last.temperature_c;
+    if (dt >= cfg.temp_delta_c || -dt >= cfg.temp_delta_c) {
+        if (sse_format(&ev, "temp", sse_render_temp) > 0) {
+            sse_broadcast(&ev);
+        }
+        last.temperature_c = in.temperature_c;
+    }
+
+    if (cfg.render_heartbeat && (u32_t)(sys_now() - last_emit_ms) >= cfg.heartbeat_ms) {
+        if (sse_format(&ev, "hb", cfg.render_heartbeat) > 0) {
+            sse_broadcast(&ev);
+        }
+    }
+
+    for (int i = 0; i < HTTP_SSE_MAX_SUBSCRIBERS; i++) {
+        if (subs[i].used && (subs[i].count > 0 || subs[i].resync)) {
+            sse_wake(&subs[i]);
+        }
+    }
+
+    sys_timeout(cfg.poll_ms, sse_tick, NULL);
+}
+
+void http_sse_init(const http_sse_config_t *config) {
+    cfg = *config;
+    if (cfg.poll_ms == 0) cfg.poll_ms = HTTP_SSE_POLL_MS;
+    if (cfg.heartbeat_ms == 0) cfg.heartbeat_ms = HTTP_SSE_HEARTBEAT_MS;
+    if (cfg.joy_deadband == 0) cfg.joy_deadband = HTTP_SSE_JOY_DEADBAND;
+    if (cfg.temp_delta_c <= 0.0f) cfg.temp_delta_c = HTTP_SSE_TEMP_DELTA_C;
+    if (cfg.heartbeat_ms >= HTTPD_POLL_INTERVAL * HTTPD_MAX_RETRIES * 500) {
+        cfg.heartbeat_ms = HTTP_SSE_HEARTBEAT_MS;
+    }
+}
+
+uint http_sse_subscriber_count(void) {
+    return sub_count;
+}
+
+uint32_t http_sse_coalesced_count(void) {
+    return coalesced;
+}
+
+bool http_sse_open(struct fs_file *file, const char *name) {
+    if (strcmp(name, HTTP_SSE_URI) != 0 || cfg.render_state == NULL) {
+        return false;
+    }
+
+    memset(file, 0, sizeof(struct fs_file));
+    file->flags = FS_FILE_FLAGS_HEADER_INCLUDED;
+
+    sse_sub_t *s = NULL;
+    for (int i = 0; i < HTTP_SSE_MAX_SUBSCRIBERS; i++) {
+        if (!subs[i].used) {
+            s = &subs[i];
+            break;
+        }
+    }
+    if (s == NULL) {
+        LOG_WARN("[SSE] Limite de %d assinantes atingido", HTTP_SSE_MAX_SUBSCRIBERS);
+        file->data = sse_busy;
+        file->len = sizeof(sse_busy) - 1;
+        file->index = file->len;
+        return true;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->used = true;
+
+    sse_event_t ev;
+    memcpy(ev.data, sse_header, sizeof(sse_header) - 1);
+    ev.len = sizeof(sse_header) - 1;
+    sse_push(s, &ev);
+    if (sse_format(&ev, "state", cfg.render_state) > 0) {
+        sse_push(s, &ev);
+    }
+
+    // No static data: httpd pulls the stream through http_sse_read(). Keeping
+    // len - index at one chunk bounds the send buffer httpd allocates for it.
+    file->data = NULL;
+    file->len = HTTP_SSE_READ_CHUNK;
+    file->index = 0;
+    file->pextension = s;
+
+    if (sub_count++ == 0) {
+        input_sampler_read(&last);
+        last_emit_ms = sys_now();
+        sys_timeout(cfg.poll_ms, sse_tick, NULL);
+    }
+    LOG_INFO("[SSE] Novo assinante (%u ativos)", sub_count);
+    return true;
+}
+
+bool http_sse_close(struct fs_file *file) {
+    sse_sub_t *s = (sse_sub_t *)file->pextension;
+    if (file->data == sse_busy) {
+        return true;
+    }
+    if (s == NULL || s < &subs[0] || s >= &subs[HTTP_SSE_MAX_SUBSCRIBERS]) {
+        return false;
+    }
+
+    s->used = false;
+    s->wait_cb = NULL;
+    file->pextension = NULL;
+    if (--sub_count == 0) {
+        sys_untimeout(sse_tick, NULL);
+    }
+    LOG_INFO("[SSE] Assinante saiu (%u ativos)", sub_count);
+    return true;
+}
+
+u8_t http_sse_canread(struct fs_file *file) {
+    sse_sub_t *s = (sse_sub_t *)file->pextension;
+    return (s == NULL || s->count > 0 || s->resync) ? 1 : 0;
+}
+
+u8_t http_sse_wait_read(struct fs_file *file, fs_wait_cb callback_fn, void *callback_arg) {
+    sse_sub_t *s = (sse_sub_t *)file->pextension;
+    if (s == NULL) {
+        return 0;
+    }
+    s->wait_cb = callback_fn;
+    s->wait_arg = callback_arg;
+    return 1;
+}
+
+int http_sse_read(struct fs_file *file, char *buffer, int count, fs_wait_cb callback_fn, void *callback_arg) {
+    sse_sub_t *s = (sse_sub_t *)file->pextension;
+    if (s == NULL) {
+        return FS_READ_EOF;
+    }
+
+    if (s->count == 0 && s->resync) {
+        sse_event_t ev;
+        s->resync = false;
+        if (sse_format(&ev, "state", cfg.render_state) > 0) {
+            sse_push(s, &ev);
+        }
+    }
+
+    int copied = 0;
+    while (s->count > 0 && copied < count) {
+        sse_event_t *ev = &s->queue[s->head];
+        int n = ev->len - s->offset;
+        if (n > count - copied) {
+            n = count - copied;
+        }
+        memcpy(buffer + copied, ev->data + s->offset, n);
+        copied += n;
+        s->offset += n;
+        if (s->offset == ev->len) {
+            s->offset = 0;
+            s->head = (s->head + 1) % HTTP_SSE_QUEUE_LEN;
+            s->count--;
+            s->header_sent = true;
+        }
+    }
+
+    if (copied == 0) {
+        s->wait_cb = callback_fn;
+        s->wait_arg = callback_arg;
+        return FS_READ_DELAYED;
+    }
+    // index stays at 0 so the stream never reaches EOF
+    return copied;
+}
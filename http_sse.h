@@ -0,0 +1,71 @@
+/**
+ * @file    http_sse.h
+ * @brief   Stream Server-Sent Events (/api/events) servido pelo httpd do lwIP
+ * @details O stream é um arquivo customizado (fs_open_custom) lido de forma
+ *          assíncrona: enquanto não há eventos, a leitura devolve
+ *          FS_READ_DELAYED e a conexão fica parada, sem consumir CPU. Um
+ *          sys_timeout compara o snapshot das entradas com o último publicado
+ *          e enfileira eventos apenas quando algo muda.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_SSE_H
+#define HTTP_SSE_H
+
+#include "lwip/apps/fs.h"
+
+#define HTTP_SSE_URI                "/api/events"
+
+// Clientes simultâneos no stream (cada um ocupa uma conexão TCP do httpd)
+#ifndef HTTP_SSE_MAX_SUBSCRIBERS
+#define HTTP_SSE_MAX_SUBSCRIBERS    4
+#endif
+
+// Eventos pendentes por cliente; ao estourar, a fila é descartada e o
+// cliente recebe um único evento "state" com o estado mais recente
+#ifndef HTTP_SSE_QUEUE_LEN
+#define HTTP_SSE_QUEUE_LEN          6
+#endif
+
+// Tamanho máximo de um evento já formatado (inclui "event:"/"data:")
+#define HTTP_SSE_EVENT_MAX          160
+
+// Bytes entregues ao httpd por leitura; limita o buffer que o httpd aloca
+// no heap do lwIP para cada conexão do stream
+#define HTTP_SSE_READ_CHUNK         (2 * HTTP_SSE_EVENT_MAX)
+
+// Valores padrão da configuração
+#define HTTP_SSE_POLL_MS            50
+#define HTTP_SSE_HEARTBEAT_MS       4000
+#define HTTP_SSE_JOY_DEADBAND       64
+#define HTTP_SSE_TEMP_DELTA_C       0.5f
+
+// Gera um JSON no buffer e retorna o tamanho (como snprintf)
+typedef int (*http_sse_render_fn)(char *buf, size_t len);
+
+typedef struct {
+    uint16_t poll_ms;                   // Período da detecção de mudanças
+    uint16_t heartbeat_ms;              // Evento "hb" quando nada mudou nesse intervalo
+    uint16_t joy_deadband;              // Variação mínima do joystick (contagens do ADC)
+    float temp_delta_c;                 // Variação mínima da temperatura
+    http_sse_render_fn render_state;    // Estado completo (evento "state")
+    http_sse_render_fn render_heartbeat; // Conteúdo do evento "hb"
+} http_sse_config_t;
+
+// Funções públicas
+void http_sse_init(const http_sse_config_t *config);
+uint http_sse_subscriber_count(void);
+uint32_t http_sse_coalesced_count(void);
+
+// Ganchos chamados pelos fs_*_custom() do httpd
+bool http_sse_open(struct fs_file *file, const char *name);
+bool http_sse_close(struct fs_file *file);
+u8_t http_sse_canread(struct fs_file *file);
+u8_t http_sse_wait_read(struct fs_file *file, fs_wait_cb callback_fn, void *callback_arg);
+int http_sse_read(struct fs_file *file, char *buffer, int count, fs_wait_cb callback_fn, void *callback_arg);
+
+#endif // HTTP_SSE_H
@@ -0,0 +1,111 @@
+/**
+ * @file    http_zerocopy.c
+ * @brief   Envio sem cópia do conteúdo embutido na flash
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/inet_chksum.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/tcp.h"
+#include "lwip/priv/tcp_priv.h"
+
+#include "http_zerocopy.h"
+#include "http_keepalive.h"
+
+#if HTTPD_ZERO_COPY && LWIP_NETIF_TX_SINGLE_PBUF
+#error "HTTPD_ZERO_COPY needs LWIP_NETIF_TX_SINGLE_PBUF 0 (see lwipopts.h)"
+#endif
+#if !MEM_STATS || !MEMP_STATS
+#error "http_zerocopy.c needs MEM_STATS and MEMP_STATS (see lwipopts.h)"
+#endif
+
+// Largest write httpd issues at once (HTTPD_MAX_WRITE_LEN default)
+#define ZC_WRITE_MAX        (2 * TCP_MSS)
+
+typedef struct {
+    uint32_t queued;        // file bytes accepted by tcp_write()
+    uint16_t segs;
+    int32_t heap;           // heap bytes held by the queued segments
+    int32_t pbufs;          // MEMP_PBUF elements (PBUF_ROM/PBUF_REF)
+    uint32_t sram;          // heap plus pool elements
+    uint32_t us;            // tcp_write() plus the output checksum
+} zc_result_t;
+
+// Queue one send buffer's worth of data on an unconnected pcb, the way
+// httpd does for a download, then checksum every segment as tcp_output()
+// would. Must run with the lwIP lock held.
+static bool zc_measure(const uint8_t *data, uint32_t len, u8_t flags, zc_result_t *out) {
+    struct tcp_pcb *pcb = tcp_new();
+    if (pcb == NULL) {
+        return false;
+    }
+    pcb->state = ESTABLISHED; // tcp_write() only queues; nothing is sent
+    pcb->mss = TCP_MSS;
+
+    const mem_size_t heap0 = lwip_stats.mem.used;
+    const mem_size_t pbuf0 = lwip_stats.memp[MEMP_PBUF]->used;
+    const mem_size_t seg0 = lwip_stats.memp[MEMP_TCP_SEG]->used;
+    volatile u16_t sink = 0; // keeps the checksums from being optimized out
+
+    uint32_t t0 = time_us_32();
+    uint32_t off = 0;
+    while (off < len) {
+        u16_t n = (u16_t)LWIP_MIN(LWIP_MIN(len - off, tcp_sndbuf(pcb)), ZC_WRITE_MAX);
+        if (n == 0 || tcp_write(pcb, data + off, n, flags) != ERR_OK) {
+            break;
+        }
+        off += n;
+    }
+    uint16_t segs = 0;
+    for (struct tcp_seg *seg = pcb->unsent; seg != NULL; seg = seg->next) {
+        sink ^= inet_chksum_pbuf(seg->p);
+        segs++;
+    }
+    out->us = time_us_32() - t0;
+
+    out->queued = off;
+    out->segs = segs;
+    out->heap = (int32_t)lwip_stats.mem.used - (int32_t)heap0;
+    out->pbufs = (int32_t)lwip_stats.memp[MEMP_PBUF]->used - (int32_t)pbuf0;
+    out->sram = (uint32_t)(out->heap + out->pbufs * memp_pools[MEMP_PBUF]->size +
+                           ((int32_t)lwip_stats.memp[MEMP_TCP_SEG]->used - (int32_t)seg0) *
+                           memp_pools[MEMP_TCP_SEG]->size);
+
+    // CLOSED: tcp_abort() frees the queued segments and the pcb, no RST
+    pcb->state = CLOSED;
+    tcp_abort(pcb);
+    return true;
+}
+
+// Queue HTTP_ZEROCOPY_BENCH_FILE copied into RAM and referenced in flash,
+// and log the SRAM and CPU time one download costs in each mode
+void http_zerocopy_benchmark(void) {
+    struct fs_file file;
+    if (!http_fsdata_open(&file, HTTP_ZEROCOPY_BENCH_FILE, 0)) {
+        return;
+    }
+    zc_result_t copy, rom;
+    cyw43_arch_lwip_begin();
+    bool ok = zc_measure((const uint8_t *)file.data, (uint32_t)file.len, TCP_WRITE_FLAG_COPY, &copy) &&
+              zc_measure((const uint8_t *)file.data, (uint32_t)file.len, 0, &rom);
+    cyw43_arch_lwip_end();
+    if (!ok) {
+        return;
+    }
+    LOG_INFO("[ZC] %s: %lu de %lu bytes enfileirados em %u segmentos por download",
+             HTTP_ZEROCOPY_BENCH_FILE, (unsigned long)copy.queued, (unsigned long)file.len, copy.segs);
+    LOG_INFO("[ZC] cópia: %lu bytes de SRAM (heap %ld), %lu us; flash: %lu bytes de SRAM (heap %ld, %ld pbufs), %lu us",
+             (unsigned long)copy.sram, (long)copy.heap, (unsigned long)copy.us,
+             (unsigned long)rom.sram, (long)rom.heap, (long)rom.pbufs, (unsigned long)rom.us);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file    http_zerocopy.h
+ * @brief   Envio sem cópia do conteúdo embutido na flash
+ * @details Os arquivos do fsdata (pico_fsdata.inc), com o cabeçalho HTTP já
+ *          embutido, ficam na flash mapeada em memória (XIP). Com
+ *          HTTPD_ZERO_COPY (padrão, ver lwipopts.h) o httpd passa esses
+ *          trechos ao tcp_write() sem TCP_WRITE_FLAG_COPY: cada segmento
+ *          referencia a flash num pbuf PBUF_ROM, e só o cabeçalho TCP/IP do
+ *          segmento sai do heap. LWIP_NETIF_TX_SINGLE_PBUF fica desligado,
+ *          senão o lwIP copiaria mesmo assim; o driver do CYW43 copia a
+ *          cadeia de pbufs direto para o buffer do SPI.
+ *
+ *          O que está na RAM continua copiado: respostas montadas em
+ *          fs_open_custom() (/api/state), leituras assíncronas (SSE,
+ *          /metrics) e os valores das tags SSI. O critério é o endereço
+ *          (HTTP_ROM_DATA), não o tipo de arquivo.
+ *
+ *          http_zerocopy_benchmark() enfileira /index.html numa conexão
+ *          fictícia nos dois modos, com o checksum que o tcp_output() faria,
+ *          e imprime a SRAM ocupada e o tempo de CPU de cada um.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HTTP_ZEROCOPY_H
+#define HTTP_ZEROCOPY_H
+
+#include "pico/stdlib.h"
+
+// Arquivo medido pelo benchmark (variante servida por padrão)
+#define HTTP_ZEROCOPY_BENCH_FILE    "/index.html"
+
+// Funções públicas
+void http_zerocopy_benchmark(void);
+
+#endif // HTTP_ZEROCOPY_H
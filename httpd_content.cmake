@@ -0,0 +1,54 @@
+# Pipeline de assets do httpd (tools/makefsdata.py): substitui
+# pico_set_lwip_httpd_content do SDK. Minifica e comprime os arquivos na
+# compilação, marca com FS_FILE_FLAGS_SSI só os que têm tags e imprime os
+# bytes de cada arquivo antes e depois. Com CHECKSUM_CHUNK grava também os
+# checksums TCP de cada bloco de arquivo estático (ver http_chksum.h).
+# BROTLI e IDENTITY gravam também as variantes br e sem compressão dos
+# arquivos estáticos, escolhidas pelo Accept-Encoding (ver http_encoding.h).
+# BUNDLE embute CSS, JS e imagens de até INLINE_MAX bytes em cada página sem
+# SSI, que passa a carregar com um único pedido.
+#
+#   httpd_content(<alvo> <INTERFACE|PUBLIC|PRIVATE> ROOT <diretório>
+#                 [CHECKSUM_CHUNK <TCP_MSS>] [BROTLI] [IDENTITY]
+#                 [BUNDLE [INLINE_MAX <bytes>]] arquivos...)
+set(HTTPD_CONTENT_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/tools/makefsdata.py)
+
+function(httpd_content TARGET TYPE)
+    cmake_parse_arguments(HTTPD_CONTENT "BROTLI;IDENTITY;BUNDLE" "ROOT;CHECKSUM_CHUNK;INLINE_MAX" "" ${ARGN})
+    if(NOT HTTPD_CONTENT_CHECKSUM_CHUNK)
+        set(HTTPD_CONTENT_CHECKSUM_CHUNK 0)
+    endif()
+    set(HTTPD_CONTENT_OPTION_ARGS)
+    if(HTTPD_CONTENT_BROTLI)
+        list(APPEND HTTPD_CONTENT_OPTION_ARGS --brotli)
+    endif()
+    if(HTTPD_CONTENT_IDENTITY)
+        list(APPEND HTTPD_CONTENT_OPTION_ARGS --identity)
+    endif()
+    if(HTTPD_CONTENT_BUNDLE)
+        list(APPEND HTTPD_CONTENT_OPTION_ARGS --bundle)
+        if(HTTPD_CONTENT_INLINE_MAX)
+            list(APPEND HTTPD_CONTENT_OPTION_ARGS --inline-max ${HTTPD_CONTENT_INLINE_MAX})
+        endif()
+    endif()
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+    set(HTTPD_CONTENT_BINARY_DIR ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}_fsdata)
+    set(HTTPD_CONTENT_FSDATA ${HTTPD_CONTENT_BINARY_DIR}/pico_fsdata.inc)
+
+    add_custom_command(
+            OUTPUT ${HTTPD_CONTENT_FSDATA}
+            COMMAND ${Python3_EXECUTABLE} ${HTTPD_CONTENT_SCRIPT}
+                    --root ${HTTPD_CONTENT_ROOT}
+                    --output ${HTTPD_CONTENT_FSDATA}
+                    --checksum-chunk ${HTTPD_CONTENT_CHECKSUM_CHUNK}
+                    ${HTTPD_CONTENT_OPTION_ARGS}
+                    ${HTTPD_CONTENT_UNPARSED_ARGUMENTS}
+            DEPENDS ${HTTPD_CONTENT_SCRIPT} ${HTTPD_CONTENT_UNPARSED_ARGUMENTS}
+            COMMENT "Gerando fsdata do httpd (minificação, gzip, flags SSI)"
+            VERBATIM
+            )
+    add_custom_target(${TARGET}_fsdata DEPENDS ${HTTPD_CONTENT_FSDATA})
+    target_include_directories(${TARGET} ${TYPE} ${HTTPD_CONTENT_BINARY_DIR})
+    add_dependencies(${TARGET} ${TARGET}_fsdata)
+endfunction()
@@ -0,0 +1,234 @@
+/**
+ * @file    buzzer.c
+ * @brief   Sequenciador de tons não bloqueante para os buzzers da BitDogLab
+ * @details Cada canal mantém uma fila circular de notas. Um alarme de hardware
+ *          (alarm pool padrão do SDK) termina a nota atual e inicia a próxima,
+ *          de modo que quem enfileira nunca espera o som terminar.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+
+#include "buzzer.h"
+
+// Estado de um canal (voz) do sequenciador.
+typedef struct {
+    uint pin;
+    uint slice;
+    buzzer_note_t queue[BUZZER_QUEUE_LEN];
+    uint8_t head;           // Índice da próxima nota a tocar
+    uint8_t count;          // Notas aguardando na fila
+    bool playing;           // Existe uma nota (ou pausa) em andamento
+    alarm_id_t alarm;       // Alarme que encerra a nota atual (0 = nenhum)
+    buzzer_note_t current;
+    uint16_t elapsed_ms;    // Progresso da varredura atual
+} buzzer_voice_t;
+
+static buzzer_voice_t voices[2];
+static volatile uint32_t dropped_notes = 0;
+
+static void buzzer_pwm_off(buzzer_voice_t *v) {
+    pwm_set_enabled(v->slice, false);
+    pwm_set_gpio_level(v->pin, 0);
+}
+
+static void buzzer_pwm_set(buzzer_voice_t *v, uint16_t freq) {
+    // Divisor inteiro para que o wrap caiba em 16 bits com duty de 50%
+    uint32_t clock_freq = clock_get_hz(clk_sys);
+    uint32_t divider = clock_freq / ((uint32_t)freq * 4096); // 4096 = max wrap value
+    if (divider < 1) divider = 1;
+    if (divider > 255) divider = 255;
+
+    uint32_t wrap = clock_freq / (divider * freq) - 1;
+    if (wrap > 65535) wrap = 65535;
+
+    pwm_set_clkdiv_int_frac(v->slice, (uint8_t)divider, 0);
+    pwm_set_wrap(v->slice, (uint16_t)wrap);
+    pwm_set_gpio_level(v->pin, (uint16_t)(wrap / 2));
+    pwm_set_enabled(v->slice, true);
+}
+
+// Avança a voz: continua a varredura em andamento ou inicia a próxima nota.
+// Retorna o atraso (us) até a próxima chamada, ou 0 quando a fila esvaziou.
+// Deve ser chamada com interrupções desabilitadas ou a partir do alarme.
+static int64_t buzzer_voice_advance(buzzer_voice_t *v) {
+    if (v->playing && v->current.kind == BUZZER_NOTE_SWEEP &&
+        v->elapsed_ms < v->current.duration_ms) {
+        uint16_t remaining = v->current.duration_ms - v->elapsed_ms;
+        uint16_t step = remaining < BUZZER_SWEEP_STEP_MS ? remaining : BUZZER_SWEEP_STEP_MS;
+        int32_t span = (int32_t)v->current.freq_end - (int32_t)v->current.freq;
+        int32_t freq = v->current.freq + span * v->elapsed_ms / v->current.duration_ms;
+        buzzer_pwm_set(v, (uint16_t)freq);
+        v->elapsed_ms += step;
+        return (int64_t)step * 1000;
+    }
+
+    if (v->count == 0) {
+        buzzer_pwm_off(v);
+        v->playing = false;
+        return 0;
+    }
+
+    v->current = v->queue[v->head];
+    v->head = (v->head + 1) % BUZZER_QUEUE_LEN;
+    v->count--;
+    v->playing = true;
+
+    if (v->current.kind == BUZZER_NOTE_REST) {
+        buzzer_pwm_off(v);
+        return (int64_t)v->current.duration_ms * 1000;
+    }
+
+    buzzer_pwm_set(v, v->current.freq);
+    if (v->current.kind == BUZZER_NOTE_SWEEP) {
+        uint16_t step = v->current.duration_ms < BUZZER_SWEEP_STEP_MS ?
+                        v->current.duration_ms : BUZZER_SWEEP_STEP_MS;
+        v->elapsed_ms = step;
+        return (int64_t)step * 1000;
+    }
+    return (int64_t)v->current.duration_ms * 1000;
+}
+
+static int64_t buzzer_alarm_cb(alarm_id_t id, void *user_data) {
+    (void)id;
+    buzzer_voice_t *v = (buzzer_voice_t *)user_data;
+    int64_t next_us = buzzer_voice_advance(v);
+    if (next_us == 0) {
+        v->alarm = 0;
+    }
+    // Retorno positivo reagenda o mesmo alarme para daqui a next_us
+    return next_us;
+}
+
+static void buzzer_clamp_note(buzzer_note_t *n) {
+    if (n->duration_ms > BUZZER_DURATION_MAX) n->duration_ms = BUZZER_DURATION_MAX;
+    if (n->duration_ms < BUZZER_DURATION_MIN) n->duration_ms = BUZZER_DURATION_MIN;
+    if (n->kind == BUZZER_NOTE_REST) return;
+    if (n->freq > BUZZER_FREQ_MAX) n->freq = BUZZER_FREQ_MAX;
+    if (n->freq < BUZZER_FREQ_MIN) n->freq = BUZZER_FREQ_MIN;
+    if (n->kind == BUZZER_NOTE_SWEEP) {
+        if (n->freq_end > BUZZER_FREQ_MAX) n->freq_end = BUZZER_FREQ_MAX;
+        if (n->freq_end < BUZZER_FREQ_MIN) n->freq_end = BUZZER_FREQ_MIN;
+    }
+}
+
+static bool buzzer_voice_push(buzzer_voice_t *v, const buzzer_note_t *note) {
+    uint32_t irq = save_and_disable_interrupts();
+
+    if (v->count >= BUZZER_QUEUE_LEN) {
+        restore_interrupts(irq);
+        dropped_notes++;
+        return false;
+    }
+    v->queue[(v->head + v->count) % BUZZER_QUEUE_LEN] = *note;
+    v->count++;
+
+    // Canal ocioso: inicia a nota aqui e deixa o alarme cuidar do resto
+    if (!v->playing) {
+        int64_t delay_us = buzzer_voice_advance(v);
+        if (delay_us > 0) {
+            alarm_id_t id = add_alarm_in_us(delay_us, buzzer_alarm_cb, v, true);
+            if (id > 0) {
+                v->alarm = id;
+            } else {
+                // Sem alarmes livres: não há como encerrar a nota, então silencia
+                buzzer_pwm_off(v);
+                v->playing = false;
+                v->count = 0;
+                dropped_notes++;
+            }
+        }
+    }
+
+    restore_interrupts(irq);
+    return true;
+}
+
+void buzzer_init(uint left_pin, uint right_pin) {
+    voices[0].pin = left_pin;
+    voices[1].pin = right_pin;
+
+    for (int i = 0; i < 2; i++) {
+        buzzer_voice_t *v = &voices[i];
+        gpio_set_function(v->pin, GPIO_FUNC_PWM);
+        v->slice = pwm_gpio_to_slice_num(v->pin);
+        v->head = 0;
+        v->count = 0;
+        v->playing = false;
+        v->alarm = 0;
+        buzzer_pwm_off(v);
+    }
+}
+
+bool buzzer_enqueue(buzzer_channel_t channel, const buzzer_note_t *note) {
+    buzzer_note_t n = *note;
+    buzzer_clamp_note(&n);
+
+    bool ok = true;
+    if (channel == BUZZER_CH_BOTH || channel == BUZZER_CH_LEFT) {
+        ok &= buzzer_voice_push(&voices[0], &n);
+    }
+    if (channel == BUZZER_CH_BOTH || channel == BUZZER_CH_RIGHT) {
+        ok &= buzzer_voice_push(&voices[1], &n);
+    }
+    return ok;
+}
+
+uint buzzer_enqueue_many(buzzer_channel_t channel, const buzzer_note_t *notes, uint count) {
+    uint accepted = 0;
+    for (uint i = 0; i < count; i++) {
+        if (buzzer_enqueue(channel, &notes[i])) {
+            accepted++;
+        }
+    }
+    return accepted;
+}
+
+bool buzzer_tone(buzzer_channel_t channel, uint16_t freq, uint16_t duration_ms) {
+    buzzer_note_t n = {
+        .kind = freq ? BUZZER_NOTE_TONE : BUZZER_NOTE_REST,
+        .freq = freq,
+        .freq_end = freq,
+        .duration_ms = duration_ms,
+    };
+    return buzzer_enqueue(channel, &n);
+}
+
+void buzzer_stop(buzzer_channel_t channel) {
+    for (int i = 0; i < 2; i++) {
+        if (channel != BUZZER_CH_BOTH && channel != (buzzer_channel_t)(i + 1)) {
+            continue;
+        }
+        buzzer_voice_t *v = &voices[i];
+        uint32_t irq = save_and_disable_interrupts();
+        if (v->alarm > 0) {
+            cancel_alarm(v->alarm);
+        }
+        v->alarm = 0;
+        v->count = 0;
+        v->playing = false;
+        buzzer_pwm_off(v);
+        restore_interrupts(irq);
+    }
+}
+
+uint buzzer_queue_depth(buzzer_channel_t channel) {
+    uint left = voices[0].count + (voices[0].playing ? 1 : 0);
+    uint right = voices[1].count + (voices[1].playing ? 1 : 0);
+    switch (channel) {
+        case BUZZER_CH_LEFT:  return left;
+        case BUZZER_CH_RIGHT: return right;
+        default:              return left > right ? left : right;
+    }
+}
+
+uint32_t buzzer_dropped_count(void) {
+    return dropped_notes;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file    buzzer.h
+ * @brief   Sequenciador de tons não bloqueante para os buzzers da BitDogLab
+ * @details Cada canal (esquerdo/direito) possui uma fila de notas consumida
+ *          por um alarme de hardware. Enfileirar uma nota retorna
+ *          imediatamente, sem busy_wait, então é seguro chamar a partir
+ *          de callbacks do lwIP (CGI/POST).
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Número de notas que cada canal pode manter enfileiradas */
+#ifndef BUZZER_QUEUE_LEN
+#define BUZZER_QUEUE_LEN        32
+#endif
+
+/** Passo de atualização da frequência durante uma varredura (sweep) */
+#ifndef BUZZER_SWEEP_STEP_MS
+#define BUZZER_SWEEP_STEP_MS    10
+#endif
+
+/** Limites aplicados a todas as notas enfileiradas */
+#define BUZZER_FREQ_MIN         100
+#define BUZZER_FREQ_MAX         10000
+#define BUZZER_DURATION_MIN     10
+#define BUZZER_DURATION_MAX     2000
+
+/** Canal de saída (mantém a numeração usada pelos handlers HTTP) */
+typedef enum {
+    BUZZER_CH_BOTH  = 0,
+    BUZZER_CH_LEFT  = 1,
+    BUZZER_CH_RIGHT = 2,
+} buzzer_channel_t;
+
+/** Tipo de nota */
+typedef enum {
+    BUZZER_NOTE_TONE  = 0,  ///< Tom fixo em @c freq
+    BUZZER_NOTE_SWEEP = 1,  ///< Varredura linear de @c freq até @c freq_end
+    BUZZER_NOTE_REST  = 2,  ///< Silêncio (pausa) com a duração indicada
+} buzzer_note_kind_t;
+
+typedef struct {
+    uint8_t  kind;          ///< buzzer_note_kind_t
+    uint16_t freq;          ///< Frequência inicial em Hz
+    uint16_t freq_end;      ///< Frequência final em Hz (apenas SWEEP)
+    uint16_t duration_ms;   ///< Duração em milissegundos
+} buzzer_note_t;
+
+/** Configura os pinos PWM e deixa os dois canais em silêncio */
+void buzzer_init(uint left_pin, uint right_pin);
+
+/**
+ * Enfileira uma nota no canal indicado (BOTH enfileira nos dois).
+ * @return false se alguma das filas estava cheia (a nota é contada como descartada)
+ */
+bool buzzer_enqueue(buzzer_channel_t channel, const buzzer_note_t *note);
+
+/**
+ * Enfileira várias notas de uma vez.
+ * @return número de notas aceitas
+ */
+uint buzzer_enqueue_many(buzzer_channel_t channel, const buzzer_note_t *notes, uint count);
+
+/** Atalho para enfileirar um tom simples */
+bool buzzer_tone(buzzer_channel_t channel, uint16_t freq, uint16_t duration_ms);
+
+/** Interrompe a nota atual e esvazia a fila do(s) canal(is) */
+void buzzer_stop(buzzer_channel_t channel);
+
+/** Notas pendentes (incluindo a que está tocando) no canal; BOTH retorna o maior valor */
+uint buzzer_queue_depth(buzzer_channel_t channel);
+
+/** Total de notas descartadas por fila cheia desde o boot */
+uint32_t buzzer_dropped_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUZZER_H
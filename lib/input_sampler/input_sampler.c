@@ -0,0 +1,101 @@
+/**
+ * @file    input_sampler.c
+ * @brief   Amostragem periódica das entradas da BitDogLab com publicação por seqlock
+ * @details O escritor é o callback do repeating timer (contexto de IRQ) e
+ *          nunca é interrompido por um leitor; um leitor interrompido no meio
+ *          da cópia percebe a mudança do contador de sequência e repete a cópia.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/adc.h"
+#include "hardware/sync.h"
+
+#include "input_sampler.h"
+
+static input_sampler_config_t cfg;
+static repeating_timer_t sampler_timer;
+
+// Seqlock: ímpar enquanto o escritor está atualizando o snapshot
+static volatile uint32_t snapshot_seq = 0;
+static input_snapshot_t snapshot;
+
+static void sampler_publish(const input_snapshot_t *s) {
+    snapshot_seq++;
+    __dmb();
+    snapshot = *s;
+    __dmb();
+    snapshot_seq++;
+}
+
+static bool sampler_timer_cb(repeating_timer_t *t) {
+    (void)t;
+    input_snapshot_t s;
+
+    s.sample = snapshot.sample + 1;
+    s.timestamp_us = time_us_64();
+
+    // Buttons (active LOW)
+    s.btn_a_pressed = !gpio_get(cfg.btn_a_pin);
+    s.btn_b_pressed = !gpio_get(cfg.btn_b_pin);
+    s.joy_btn_pressed = !gpio_get(cfg.joy_btn_pin);
+
+    // Joystick ADC
+    adc_select_input(cfg.joy_x_adc);
+    s.joystick_x = adc_read();
+    adc_select_input(cfg.joy_y_adc);
+    s.joystick_y = adc_read();
+
+    // Internal temperature sensor
+    // Formula from RP2040 datasheet: T = 27 - (ADC_voltage - 0.706) / 0.001721
+    adc_select_input(cfg.temp_adc);
+    float voltage = adc_read() * 3.3f / 4096.0f;
+    s.temperature_c = 27.0f - (voltage - 0.706f) / 0.001721f;
+
+    sampler_publish(&s);
+    return true;
+}
+
+bool input_sampler_init(const input_sampler_config_t *config) {
+    cfg = *config;
+    if (cfg.period_ms == 0) {
+        cfg.period_ms = INPUT_SAMPLER_PERIOD_MS;
+    }
+
+    // Valores neutros até a primeira amostra
+    input_snapshot_t initial = {
+        .joystick_x = 2048,
+        .joystick_y = 2048,
+    };
+    sampler_publish(&initial);
+
+    // Primeira amostra síncrona para que os leitores nunca vejam valores vazios
+    sampler_timer_cb(NULL);
+
+    // Intervalo negativo: período fixo contado do início de cada amostragem
+    return add_repeating_timer_ms(-(int32_t)cfg.period_ms, sampler_timer_cb, NULL, &sampler_timer);
+}
+
+void input_sampler_read(input_snapshot_t *out) {
+    uint32_t seq;
+    do {
+        seq = snapshot_seq;
+        if (seq & 1) {
+            continue; // escritor no meio da atualização
+        }
+        __dmb();
+        *out = snapshot;
+        __dmb();
+    } while ((seq & 1) || seq != snapshot_seq);
+}
+
+uint32_t input_sampler_sample_count(void) {
+    input_snapshot_t s;
+    input_sampler_read(&s);
+    return s.sample;
+}
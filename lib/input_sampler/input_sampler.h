@@ -0,0 +1,66 @@
+/**
+ * @file    input_sampler.h
+ * @brief   Amostragem periódica das entradas da BitDogLab (botões, joystick, temperatura)
+ * @details Um repeating timer lê o hardware em segundo plano e publica o
+ *          resultado em um snapshot protegido por seqlock. Leitores (SSI,
+ *          endpoints JSON etc.) apenas copiam o snapshot, sem acessar o ADC.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef INPUT_SAMPLER_H
+#define INPUT_SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Período padrão de amostragem */
+#ifndef INPUT_SAMPLER_PERIOD_MS
+#define INPUT_SAMPLER_PERIOD_MS     20
+#endif
+
+/** Pinos e canais lidos pelo amostrador */
+typedef struct {
+    uint btn_a_pin;         ///< Botão A (ativo em LOW)
+    uint btn_b_pin;         ///< Botão B (ativo em LOW)
+    uint joy_btn_pin;       ///< Botão do joystick (ativo em LOW)
+    uint joy_x_adc;         ///< Canal ADC do eixo X
+    uint joy_y_adc;         ///< Canal ADC do eixo Y
+    uint temp_adc;          ///< Canal ADC do sensor de temperatura interno
+    uint32_t period_ms;     ///< Período de amostragem (0 = INPUT_SAMPLER_PERIOD_MS)
+} input_sampler_config_t;
+
+/** Snapshot publicado a cada amostragem */
+typedef struct {
+    uint32_t sample;        ///< Número da amostra (incrementa a cada período)
+    uint64_t timestamp_us;  ///< Instante da amostragem (time_us_64)
+    bool btn_a_pressed;
+    bool btn_b_pressed;
+    bool joy_btn_pressed;
+    uint16_t joystick_x;    ///< 0-4095
+    uint16_t joystick_y;    ///< 0-4095
+    float temperature_c;    ///< Temperatura do chip em °C
+} input_snapshot_t;
+
+/** Configura GPIO/ADC e inicia a amostragem periódica */
+bool input_sampler_init(const input_sampler_config_t *config);
+
+/** Copia o snapshot mais recente (O(1), sem acesso ao hardware) */
+void input_sampler_read(input_snapshot_t *out);
+
+/** Número da amostra mais recente publicada */
+uint32_t input_sampler_sample_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INPUT_SAMPLER_H
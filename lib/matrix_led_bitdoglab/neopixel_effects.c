@@ -0,0 +1,482 @@
+/**
+ * @file    neopixel_effects.c
+ * @brief   Motor de efeitos da matriz WS2818B executado no firmware
+ * @details Os efeitos são os mesmos que o app.js animava enviando um quadro
+ *          completo a cada 100-300 ms. Aqui cada quadro é calculado no
+ *          callback de um repeating timer e enviado por DMA (npWriteAsync).
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+#include "pico/stdlib.h"
+
+#include "neopixel_pio.h"
+#include "neopixel_effects.h"
+
+// Nome e intervalo padrão (ms) de cada efeito (NP_FX_LIST).
+typedef struct {
+  const char *name;
+  uint16_t interval_ms;
+} fx_info_t;
+
+static const fx_info_t fx_info[NP_FX_COUNT] = {
+#define NP_FX_INFO(id, name, interval_ms) [id] = { name, interval_ms },
+  NP_FX_LIST(NP_FX_INFO)
+#undef NP_FX_INFO
+};
+
+// Fonte 3x5 para o efeito "scroll": 3 colunas por caractere, bit 0 = linha de cima.
+static const char fx_font_chars[] = " !-.0123456789:?ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const uint8_t fx_font[][3] = {
+  {0x00, 0x00, 0x00}, // ' '
+  {0x00, 0x17, 0x00}, // '!'
+  {0x04, 0x04, 0x04}, // '-'
+  {0x00, 0x10, 0x00}, // '.'
+  {0x1F, 0x11, 0x1F}, // '0'
+  {0x12, 0x1F, 0x10}, // '1'
+  {0x1D, 0x15, 0x17}, // '2'
+  {0x11, 0x15, 0x1F}, // '3'
+  {0x07, 0x04, 0x1F}, // '4'
+  {0x17, 0x15, 0x1D}, // '5'
+  {0x1F, 0x15, 0x1D}, // '6'
+  {0x01, 0x1D, 0x03}, // '7'
+  {0x1F, 0x15, 0x1F}, // '8'
+  {0x17, 0x15, 0x1F}, // '9'
+  {0x00, 0x0A, 0x00}, // ':'
+  {0x01, 0x15, 0x02}, // '?'
+  {0x1E, 0x05, 0x1E}, // 'A'
+  {0x1F, 0x15, 0x0A}, // 'B'
+  {0x0E, 0x11, 0x11}, // 'C'
+  {0x1F, 0x11, 0x0E}, // 'D'
+  {0x1F, 0x15, 0x11}, // 'E'
+  {0x1F, 0x05, 0x01}, // 'F'
+  {0x0E, 0x11, 0x1D}, // 'G'
+  {0x1F, 0x04, 0x1F}, // 'H'
+  {0x11, 0x1F, 0x11}, // 'I'
+  {0x08, 0x10, 0x0F}, // 'J'
+  {0x1F, 0x04, 0x1B}, // 'K'
+  {0x1F, 0x10, 0x10}, // 'L'
+  {0x1F, 0x06, 0x1F}, // 'M'
+  {0x1F, 0x01, 0x1E}, // 'N'
+  {0x0E, 0x11, 0x0E}, // 'O'
+  {0x1F, 0x05, 0x02}, // 'P'
+  {0x0E, 0x19, 0x16}, // 'Q'
+  {0x1F, 0x05, 0x1A}, // 'R'
+  {0x12, 0x15, 0x09}, // 'S'
+  {0x01, 0x1F, 0x01}, // 'T'
+  {0x1F, 0x10, 0x1F}, // 'U'
+  {0x0F, 0x10, 0x0F}, // 'V'
+  {0x1F, 0x0C, 0x1F}, // 'W'
+  {0x1B, 0x04, 0x1B}, // 'X'
+  {0x03, 0x1C, 0x03}, // 'Y'
+  {0x19, 0x15, 0x13}, // 'Z'
+};
+
+// Posição de cada LED (índice visual) na espiral a partir do centro.
+static const uint8_t fx_spiral_pos[25] = {
+  23, 10, 9, 22, 21, 11, 6, 1, 5, 20, 12, 2, 0, 4, 19, 13, 7, 3, 8, 18, 14, 15, 16, 17, 24
+};
+
+// Ângulo de cada LED em relação ao centro (0-255), usado pela roda de cores.
+static const uint8_t fx_wheel_angle[25] = {
+  32, 45, 64, 82, 96, 18, 32, 64, 96, 109, 0, 0, 128, 128, 128, 237, 224, 192, 160, 146, 224, 210, 192, 173, 160
+};
+
+static const uint32_t fx_chase_colors[] = { 0xff0000, 0x00ff00, 0x0000ff, 0xffff00, 0xff00ff, 0x00ffff };
+static const uint32_t fx_pulse_colors[] = { 0xff0000, 0xff7700, 0xffff00, 0x00ff00, 0x0077ff, 0x8800ff };
+static const uint32_t fx_disco_colors[] = { 0xff0000, 0x00ff00, 0x0000ff, 0xffff00, 0xff00ff, 0x00ffff, 0xffffff };
+
+// Estado do efeito ativo.
+static struct {
+  np_effect_params_t p;
+  uint16_t interval_ms;
+  uint32_t frame;
+  uint32_t elapsed_ms;
+  uint32_t rng;
+  uint8_t drops[5];
+  float blobs[3][3];  // x, y, hue
+  uint16_t text_len;
+} fx;
+
+static repeating_timer_t fx_timer;
+static volatile bool fx_running = false;
+
+// Quadros enviados pelo cliente para o efeito "frames" (ordem do hardware).
+static uint8_t fx_frames[NP_FX_MAX_FRAMES][25][3];
+static uint fx_frames_pixels = 0;  // Cores carregadas em fx_frames
+
+// ===== Auxiliares =====
+
+static uint32_t fx_rand(void) {
+  // xorshift32: barato e suficiente para brilhos e gotas.
+  uint32_t x = fx.rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  fx.rng = x;
+  return x;
+}
+
+// Coordenadas visuais (x = coluna, y = linha a partir de cima), com a mesma
+// inversão vertical que o app.js aplica antes de enviar /matrix.cgi.
+static void fx_set(uint x, uint y, uint8_t r, uint8_t g, uint8_t b) {
+  npSetLED((4 - y) * 5 + x, r, g, b);
+}
+
+static void fx_set_i(uint i, uint8_t r, uint8_t g, uint8_t b) {
+  fx_set(i % 5, i / 5, r, g, b);
+}
+
+static void fx_set_rgb(uint i, uint32_t rgb) {
+  fx_set_i(i, (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+}
+
+static void fx_hsv(uint8_t h, uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b) {
+  uint8_t region = h / 43;
+  uint8_t rem = (h - region * 43) * 6;
+  uint8_t q = (v * (255 - rem)) >> 8;
+  uint8_t t = (v * rem) >> 8;
+  switch (region) {
+    case 0:  *r = v; *g = t; *b = 0; break;
+    case 1:  *r = q; *g = v; *b = 0; break;
+    case 2:  *r = 0; *g = v; *b = t; break;
+    case 3:  *r = 0; *g = q; *b = v; break;
+    case 4:  *r = t; *g = 0; *b = v; break;
+    default: *r = v; *g = 0; *b = q; break;
+  }
+}
+
+static void fx_set_hue(uint i, uint8_t hue, uint8_t v) {
+  uint8_t r, g, b;
+  fx_hsv(hue, v, &r, &g, &b);
+  fx_set_i(i, r, g, b);
+}
+
+// Anel (distância de Chebyshev ao centro): 0 = centro, 2 = borda.
+static uint fx_ring(uint i) {
+  int dx = (int)(i % 5) - 2;
+  int dy = (int)(i / 5) - 2;
+  if (dx < 0) dx = -dx;
+  if (dy < 0) dy = -dy;
+  return dx > dy ? dx : dy;
+}
+
+static uint8_t fx_scroll_column(uint k) {
+  // 5 colunas vazias para o texto entrar pela direita, depois 3 colunas + 1 de espaço por caractere.
+  if (k < 5) return 0;
+  k -= 5;
+  uint sub = k % 4;
+  if (sub == 3) return 0;
+  char c = (char)toupper((unsigned char)fx.p.text[k / 4]);
+  const char *pos = strchr(fx_font_chars, c);
+  uint glyph = (pos && c) ? (uint)(pos - fx_font_chars) : (uint)(strchr(fx_font_chars, '?') - fx_font_chars);
+  return fx_font[glyph][sub];
+}
+
+// ===== Renderização =====
+
+static void fx_render(void) {
+  const uint32_t f = fx.frame;
+  const uint8_t cr = fx.p.r, cg = fx.p.g, cb = fx.p.b;
+
+  switch (fx.p.effect) {
+    case NP_FX_WAVE_DOWN:
+    case NP_FX_WAVE_UP: {
+      npClear();
+      uint row = fx.p.effect == NP_FX_WAVE_DOWN ? f % 5 : 4 - f % 5;
+      for (uint col = 0; col < 5; col++) fx_set(col, row, cr, cg, cb);
+      break;
+    }
+    case NP_FX_WAVE_RIGHT:
+    case NP_FX_WAVE_LEFT: {
+      npClear();
+      uint col = fx.p.effect == NP_FX_WAVE_RIGHT ? f % 5 : 4 - f % 5;
+      for (uint row = 0; row < 5; row++) fx_set(col, row, cr, cg, cb);
+      break;
+    }
+    case NP_FX_EXPAND:
+      npClear();
+      for (uint i = 0; i < 25; i++) {
+        if (fx_ring(i) == f % 3) fx_set_i(i, cr, cg, cb);
+      }
+      break;
+    case NP_FX_RAINBOW:
+      for (uint i = 0; i < 25; i++) {
+        fx_set_hue(i, (uint8_t)(((i % 5 + i / 5 + f) % 10) * 256 / 10), 255);
+      }
+      break;
+    case NP_FX_SPIRAL:
+      for (uint i = 0; i < 25; i++) {
+        fx_set_hue(i, (uint8_t)(((fx_spiral_pos[i] + f) % 25) * 256 / 25), 255);
+      }
+      break;
+    case NP_FX_CHASE: {
+      npClear();
+      uint pos = f % 25;
+      uint ci = (f / 25) % 6;
+      for (uint k = 0; k < 3; k++) fx_set_rgb((pos + k) % 25, fx_chase_colors[(ci + k) % 6]);
+      break;
+    }
+    case NP_FX_BREATHE: {
+      uint phase = f % 40;
+      uint level = phase <= 20 ? phase * 5 : (40 - phase) * 5; // 0-100%
+      for (uint i = 0; i < 25; i++) fx_set_i(i, cr * level / 100, cg * level / 100, cb * level / 100);
+      break;
+    }
+    case NP_FX_BLINK:
+      for (uint i = 0; i < 25; i++) {
+        if (f % 2 == 0) fx_set_i(i, cr, cg, cb);
+        else fx_set_i(i, 0, 0, 0);
+      }
+      break;
+    case NP_FX_FIRE:
+      for (uint i = 0; i < 25; i++) {
+        uint row = i / 5;
+        uint intensity = 128 + fx_rand() % 128;
+        uint g = (50 + (4 - row) * 40) * intensity / 255 * (fx_rand() % 256) / 255;
+        fx_set_i(i, intensity, g, 0);
+      }
+      break;
+    case NP_FX_SPARKLE: {
+      npClear();
+      uint n = 3 + fx_rand() % 3;
+      for (uint s = 0; s < n; s++) fx_set_hue(fx_rand() % 25, fx_rand() & 0xFF, 255);
+      break;
+    }
+    case NP_FX_WHEEL:
+      for (uint i = 0; i < 25; i++) fx_set_hue(i, (uint8_t)(fx_wheel_angle[i] + f * 13), 255);
+      break;
+    case NP_FX_GRADIENT:
+      for (uint i = 0; i < 25; i++) {
+        uint t = (i % 5 + i / 5 + f) % 8;
+        // Interpola da cor base até a complementar em 8 passos
+        fx_set_i(i, cr + ((255 - 2 * cr) * (int)t) / 8,
+                    cg + ((255 - 2 * cg) * (int)t) / 8,
+                    cb + ((255 - 2 * cb) * (int)t) / 8);
+      }
+      break;
+    case NP_FX_PULSE: {
+      npClear();
+      uint32_t color = fx_pulse_colors[(f / 3) % 6];
+      for (uint i = 0; i < 25; i++) {
+        if (fx_ring(i) == f % 3) fx_set_rgb(i, color);
+      }
+      break;
+    }
+    case NP_FX_RANDOM:
+      for (uint i = 0; i < 25; i++) fx_set_hue(i, fx_rand() & 0xFF, 255);
+      break;
+    case NP_FX_RAIN:
+      npClear();
+      for (uint col = 0; col < 5; col++) {
+        static const uint8_t trail_level[3] = { 255, 178, 102 };
+        for (uint trail = 0; trail < 3; trail++) {
+          uint row = (fx.drops[col] + 5 - trail) % 5;
+          fx_set(col, row, 0, trail_level[trail], 0);
+        }
+        if (fx_rand() % 10 >= 3) fx.drops[col] = (fx.drops[col] + 1) % 5;
+      }
+      break;
+    case NP_FX_OCEAN: {
+      float phase = f * 0.5f;
+      for (uint i = 0; i < 25; i++) {
+        uint row = i / 5, col = i % 5;
+        float wave = sinf((col + phase) * 0.8f) * 0.5f + 0.5f;
+        float depth = (4 - row) / 4.0f;
+        fx_set_i(i, 0, (uint8_t)(100 * wave * depth), (uint8_t)(200 + 55 * wave));
+      }
+      break;
+    }
+    case NP_FX_LAVA:
+      npClear();
+      for (uint n = 0; n < 3; n++) {
+        float *blob = fx.blobs[n];
+        blob[0] += ((int)(fx_rand() % 256) - 128) / 320.0f; // +-0.4
+        blob[1] += ((int)(fx_rand() % 256) - 128) / 320.0f;
+        blob[0] = blob[0] < 0 ? 0 : (blob[0] > 4 ? 4 : blob[0]);
+        blob[1] = blob[1] < 0 ? 0 : (blob[1] > 4 ? 4 : blob[1]);
+        blob[2] += 0.02f;
+        if (blob[2] >= 1.0f) blob[2] -= 1.0f;
+        for (uint i = 0; i < 25; i++) {
+          float dx = (i % 5) - blob[0];
+          float dy = (i / 5) - blob[1];
+          float dist = sqrtf(dx * dx + dy * dy);
+          if (dist < 1.8f) fx_set_hue(i, (uint8_t)(blob[2] * 255), (uint8_t)((1 - dist / 1.8f) * 255));
+        }
+      }
+      break;
+    case NP_FX_POLICE:
+      npClear();
+      for (uint row = 0; row < 5; row++) {
+        if (f % 4 < 2) {
+          fx_set(0, row, 0, 0, 255);
+          fx_set(1, row, 0, 0, 255);
+        } else {
+          fx_set(3, row, 255, 0, 0);
+          fx_set(4, row, 255, 0, 0);
+        }
+      }
+      break;
+    case NP_FX_DISCO:
+      npClear();
+      for (uint i = 0; i < 25; i++) {
+        if (fx_rand() % 10 >= 6) fx_set_rgb(i, fx_disco_colors[fx_rand() % 7]);
+      }
+      break;
+    case NP_FX_FRAMES:
+      npFramesShow(f % npFramesCount());
+      break;
+    case NP_FX_SCROLL: {
+      uint total = 5 + fx.text_len * 4;
+      for (uint x = 0; x < 5; x++) {
+        uint8_t bits = fx_scroll_column((f + x) % total);
+        for (uint y = 0; y < 5; y++) {
+          if (bits & (1u << y)) fx_set(x, y, cr, cg, cb);
+          else fx_set(x, y, 0, 0, 0);
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static bool fx_timer_cb(repeating_timer_t *t) {
+  (void)t;
+  if (fx.p.duration_ms && fx.elapsed_ms >= fx.p.duration_ms) {
+    npClear();
+    npWriteAsync();
+    fx.p.effect = NP_FX_NONE;
+    fx_running = false;
+    return false; // encerra o timer
+  }
+  fx_render();
+  npWriteAsync();
+  fx.frame++;
+  fx.elapsed_ms += fx.interval_ms;
+  return true;
+}
+
+// ===== API pública =====
+
+/**
+ * Inicia um efeito, substituindo o que estiver em execução.
+ */
+bool npEffectStart(const np_effect_params_t *params) {
+  if (params->effect <= NP_FX_NONE || params->effect >= NP_FX_COUNT) {
+    return false;
+  }
+  if (params->effect == NP_FX_FRAMES && npFramesCount() == 0) {
+    return false;
+  }
+
+  npEffectStop(false);
+
+  memset(&fx, 0, sizeof(fx));
+  fx.p = *params;
+  fx.p.text[NP_FX_TEXT_MAX - 1] = '\0';
+  fx.text_len = (uint16_t)strlen(fx.p.text);
+  fx.interval_ms = params->interval_ms ? params->interval_ms : fx_info[params->effect].interval_ms;
+  if (fx.interval_ms < NP_FX_MIN_INTERVAL_MS) fx.interval_ms = NP_FX_MIN_INTERVAL_MS;
+  fx.rng = time_us_32() | 1;
+
+  static const float blob_init[3][3] = { {1, 2, 0.0f}, {3, 1, 0.3f}, {2, 3, 0.6f} };
+  memcpy(fx.blobs, blob_init, sizeof(fx.blobs));
+
+  // Intervalo negativo: o período é contado a partir do início de cada callback anterior
+  fx_running = add_repeating_timer_ms(-(int32_t)fx.interval_ms, fx_timer_cb, NULL, &fx_timer);
+  if (!fx_running) {
+    fx.p.effect = NP_FX_NONE;
+  }
+  return fx_running;
+}
+
+/**
+ * Para o efeito ativo. Com clear = true a matriz é apagada.
+ */
+void npEffectStop(bool clear) {
+  if (fx_running) {
+    cancel_repeating_timer(&fx_timer);
+    fx_running = false;
+  }
+  fx.p.effect = NP_FX_NONE;
+  if (clear) {
+    npClear();
+    npWriteAsync();
+  }
+}
+
+np_effect_t npEffectCurrent(void) {
+  return fx_running ? fx.p.effect : NP_FX_NONE;
+}
+
+np_effect_t npEffectFromName(const char *name) {
+  for (int i = NP_FX_NONE + 1; i < NP_FX_COUNT; i++) {
+    if (strcmp(name, fx_info[i].name) == 0) {
+      return (np_effect_t)i;
+    }
+  }
+  return NP_FX_NONE;
+}
+
+const char *npEffectName(np_effect_t effect) {
+  if (effect < NP_FX_NONE || effect >= NP_FX_COUNT) {
+    return fx_info[NP_FX_NONE].name;
+  }
+  return fx_info[effect].name;
+}
+
+// ===== Quadros do efeito "frames" =====
+
+/**
+ * Descarta os quadros carregados. Para o efeito "frames" se estiver ativo,
+ * já que o timer leria o buffer enquanto ele é reescrito.
+ */
+void npFramesClear(void) {
+  if (npEffectCurrent() == NP_FX_FRAMES) {
+    npEffectStop(false);
+  }
+  memset(fx_frames, 0, sizeof(fx_frames));
+  fx_frames_pixels = 0;
+}
+
+/**
+ * Acrescenta a próxima cor. Retorna false quando o buffer está cheio.
+ */
+bool npFramesPush(uint8_t r, uint8_t g, uint8_t b) {
+  if (fx_frames_pixels >= NP_FX_MAX_FRAMES * 25) {
+    return false;
+  }
+  uint8_t *px = fx_frames[fx_frames_pixels / 25][fx_frames_pixels % 25];
+  px[0] = r;
+  px[1] = g;
+  px[2] = b;
+  fx_frames_pixels++;
+  return true;
+}
+
+/**
+ * Quadros carregados; um quadro incompleto conta, com os LEDs restantes apagados.
+ */
+uint npFramesCount(void) {
+  return (fx_frames_pixels + 24) / 25;
+}
+
+/**
+ * Copia um quadro para leds[]; o envio fica com quem chama (npWriteAsync()).
+ */
+void npFramesShow(uint frame) {
+  if (frame >= NP_FX_MAX_FRAMES) {
+    return;
+  }
+  for (uint i = 0; i < 25; i++) {
+    npSetLED(i, fx_frames[frame][i][0], fx_frames[frame][i][1], fx_frames[frame][i][2]);
+  }
+}
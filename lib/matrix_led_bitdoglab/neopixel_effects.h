@@ -0,0 +1,86 @@
+/**
+ * @file    neopixel_effects.h
+ * @brief   Motor de efeitos da matriz WS2818B executado no firmware
+ * @details Um timer repetitivo renderiza o próximo quadro do efeito ativo
+ *          diretamente em leds[] e o envia com npWriteAsync(). Uma única
+ *          requisição HTTP inicia o efeito; nenhum quadro trafega pela rede.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef NEOPIXEL_EFFECTS_H
+#define NEOPIXEL_EFFECTS_H
+
+#include "pico/stdlib.h"
+
+// Tamanho máximo do texto do efeito "scroll" (incluindo o terminador).
+#define NP_FX_TEXT_MAX 32
+
+// Intervalo mínimo entre quadros aceito pelo motor de efeitos.
+#define NP_FX_MIN_INTERVAL_MS 20
+
+// Quadros que o efeito "frames" armazena (25 LEDs RGB cada).
+#define NP_FX_MAX_FRAMES 16
+
+// Efeitos: X(id, nome, intervalo padrão em ms). Os nomes são os usados pelo
+// app.js e pelo parâmetro "fx" de /fx.cgi, cuja tabela de hash é gerada a
+// partir desta lista (ver http_routes.def).
+#define NP_FX_LIST(X) \
+  X(NP_FX_NONE,       "none",       0) \
+  X(NP_FX_WAVE_DOWN,  "wave_down",  200) \
+  X(NP_FX_WAVE_UP,    "wave_up",    200) \
+  X(NP_FX_WAVE_RIGHT, "wave_right", 200) \
+  X(NP_FX_WAVE_LEFT,  "wave_left",  200) \
+  X(NP_FX_EXPAND,     "expand",     300) \
+  X(NP_FX_RAINBOW,    "rainbow",    150) \
+  X(NP_FX_SPIRAL,     "spiral",     100) \
+  X(NP_FX_CHASE,      "chase",      80) \
+  X(NP_FX_BREATHE,    "breathe",    50) \
+  X(NP_FX_BLINK,      "blink",      300) \
+  X(NP_FX_FIRE,       "fire",       100) \
+  X(NP_FX_SPARKLE,    "sparkle",    100) \
+  X(NP_FX_WHEEL,      "wheel",      100) \
+  X(NP_FX_GRADIENT,   "gradient",   150) \
+  X(NP_FX_PULSE,      "pulse",      150) \
+  X(NP_FX_RANDOM,     "random",     200) \
+  X(NP_FX_RAIN,       "rain",       120) \
+  X(NP_FX_OCEAN,      "ocean",      100) \
+  X(NP_FX_LAVA,       "lava",       100) \
+  X(NP_FX_POLICE,     "police",     150) \
+  X(NP_FX_DISCO,      "disco",      100) \
+  X(NP_FX_SCROLL,     "scroll",     150) \
+  X(NP_FX_FRAMES,     "frames",     100)
+
+typedef enum {
+#define NP_FX_ENUM(id, name, interval_ms) id,
+  NP_FX_LIST(NP_FX_ENUM)
+#undef NP_FX_ENUM
+  NP_FX_COUNT
+} np_effect_t;
+
+// Parâmetros de um efeito.
+typedef struct {
+  np_effect_t effect;
+  uint8_t r, g, b;            // Cor base (efeitos que usam uma cor)
+  uint16_t interval_ms;       // Intervalo entre quadros (0 = padrão do efeito)
+  uint32_t duration_ms;       // Duração total (0 = até npEffectStop())
+  char text[NP_FX_TEXT_MAX];  // Texto do efeito "scroll"
+} np_effect_params_t;
+
+// Funções públicas
+bool npEffectStart(const np_effect_params_t *params);
+void npEffectStop(bool clear);
+np_effect_t npEffectCurrent(void);
+np_effect_t npEffectFromName(const char *name);
+const char *npEffectName(np_effect_t effect);
+
+// Quadros do efeito "frames", carregados cor a cor na ordem do hardware
+void npFramesClear(void);
+bool npFramesPush(uint8_t r, uint8_t g, uint8_t b);
+uint npFramesCount(void);
+void npFramesShow(uint frame);
+
+#endif // NEOPIXEL_EFFECTS_H
@@ -11,14 +11,13 @@
  
 #include <hardware/timer.h>
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
-
-#if FREERTOS_ENABLED
-#include "FreeRTOS.h"
-#include "task.h"
-#endif
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 
 #include "neopixel_pio.h"
 
@@ -34,12 +33,75 @@ typedef struct pixel_t pixel_t;
 typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
 
 // Declaração do buffer de pixels que formam a matriz.
+// É o buffer de trás (back buffer): pode ser alterado enquanto o DMA envia o quadro anterior.
 npLED_t leds[LED_COUNT];
 
+// Buffer da frente: cópia do quadro que o DMA está enviando para a PIO.
+static uint8_t np_front[LED_COUNT * sizeof(npLED_t)];
+
 // Variáveis para uso da máquina PIO.
 PIO np_pio;
 uint sm;
 
+// Canal DMA que alimenta o TX FIFO da PIO.
+static int np_dma_chan = -1;
+
+// true enquanto um quadro está sendo transmitido ou aguardando o reset (latch).
+static volatile bool np_busy = false;
+// true quando npWriteAsync() foi chamado durante uma transmissão: o próximo
+// quadro é enviado assim que o latch terminar (quadros intermediários são descartados).
+static volatile bool np_pending = false;
+
+// Tempo entre o fim do DMA e o próximo quadro: esvaziar o FIFO (8 bytes + o byte
+// no registrador de deslocamento, 10 us cada a 800 kHz) mais o reset do WS2812B (>= 280 us).
+#define NP_LATCH_US (9 * 10 + 300)
+
+static void np_start_frame(void) {
+  memcpy(np_front, leds, sizeof(np_front));
+  dma_channel_transfer_from_buffer_now(np_dma_chan, np_front, sizeof(np_front));
+}
+
+static int64_t np_latch_cb(alarm_id_t id, void *user_data) {
+  (void)id;
+  (void)user_data;
+  if (np_pending) {
+    np_pending = false;
+    np_start_frame();
+  } else {
+    np_busy = false;
+  }
+  return 0;
+}
+
+static void np_dma_irq_handler(void) {
+  if (!dma_channel_get_irq0_status(np_dma_chan)) {
+    return; // IRQ compartilhada: não é o nosso canal
+  }
+  dma_channel_acknowledge_irq0(np_dma_chan);
+  // O reset de 100+ us é contado por um alarme em vez de uma espera ativa.
+  if (add_alarm_in_us(NP_LATCH_US, np_latch_cb, NULL, true) <= 0) {
+    np_pending = false;
+    np_busy = false;
+  }
+}
+
+static void np_dma_init(void) {
+  np_dma_chan = dma_claim_unused_channel(true);
+
+  dma_channel_config c = dma_channel_get_default_config(np_dma_chan);
+  // Escritas de 8 bits são replicadas nas 4 lanes do barramento, então cada byte
+  // chega ao FIFO exatamente como com pio_sm_put_blocking(byte).
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(np_pio, sm, true));
+  dma_channel_configure(np_dma_chan, &c, &np_pio->txf[sm], np_front, sizeof(np_front), false);
+
+  dma_channel_set_irq0_enabled(np_dma_chan, true);
+  irq_add_shared_handler(DMA_IRQ_0, np_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_0, true);
+}
+
 /**
  * Inicializa a máquina PIO para controle da matriz de LEDs.
  */
@@ -59,6 +121,9 @@ void npInit(uint pin) {
   // Inicia programa na máquina PIO obtida.
   ws2818b_program_init(np_pio, sm, offset, pin, 800000.f);
 
+  // Configura o DMA que envia o buffer da frente para a PIO.
+  np_dma_init();
+
   // Limpa buffer de pixels.
   for (uint i = 0; i < LED_COUNT; ++i) {
     leds[i].R = 0;
@@ -85,22 +150,39 @@ void npClear() {
 }
 
 /**
- * Escreve os dados do buffer nos LEDs.
+ * Inicia o envio do buffer para os LEDs sem bloquear.
+ * Se um quadro ainda estiver em transmissão, o buffer atual será enviado
+ * logo após o latch do anterior (apenas o quadro mais recente é mantido).
+ * Retorna true se a transmissão começou imediatamente.
  */
-void npWrite() {
-  // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
-  for (uint i = 0; i < LED_COUNT; ++i) {
-    pio_sm_put_blocking(np_pio, sm, leds[i].G);
-    pio_sm_put_blocking(np_pio, sm, leds[i].R);
-    pio_sm_put_blocking(np_pio, sm, leds[i].B);
+bool npWriteAsync() {
+  bool started = false;
+  uint32_t irq = save_and_disable_interrupts();
+  if (np_busy) {
+    np_pending = true;
+  } else {
+    np_busy = true;
+    np_start_frame();
+    started = true;
   }
-#if FREERTOS_ENABLED // se o FreeRTOS estiver habilitado e estiver dentro de um task usa vTaskDelay
-  if(xTaskGetCurrentTaskHandle() != NULL){
-    vTaskDelay(pdMS_TO_TICKS(100)); // está dentro de uma task - delay em milissegundos
-  }else{
-    busy_wait_ms(100); // está fora de uma task
+  restore_interrupts(irq);
+  return started;
+}
+
+/**
+ * Indica se há um quadro em transmissão, em latch ou aguardando envio.
+ */
+bool npIsBusy() {
+  return np_busy || np_pending;
+}
+
+/**
+ * Escreve os dados do buffer nos LEDs e aguarda o fim do reset (latch).
+ * Mantida por compatibilidade; prefira npWriteAsync() em callbacks de rede.
+ */
+void npWrite() {
+  npWriteAsync();
+  while (npIsBusy()) {
+    tight_loop_contents();
   }
-#else
-  busy_wait_ms(100); // Espera 100us, sinal de RESET do datasheet.
-#endif
 }
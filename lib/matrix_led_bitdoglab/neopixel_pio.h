@@ -14,5 +14,7 @@ void npInit(uint pin);
 void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b);
 void npClear(void);
 void npWrite(void);
+bool npWriteAsync(void);
+bool npIsBusy(void);
 
 #endif // NEOPIXEL_PIO_H
\ No newline at end of file
@@ -0,0 +1,31 @@
+/**
+ * @file    lwip_hooks.h
+ * @brief   Hooks do lwIP usados pelo BitDogLab HTTP Server
+ * @details Incluído pelo lwIP através de LWIP_HOOK_FILENAME (lwipopts.h).
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef LWIP_HOOKS_H
+#define LWIP_HOOKS_H
+
+#include "lwip/arch.h"
+#include "lwip/err.h"
+
+struct tcp_pcb;
+struct tcp_hdr;
+struct pbuf;
+
+// Admissão de conexões com os PCBs esgotados (http_admission.c)
+err_t http_admission_inpacket(struct tcp_pcb *pcb, const struct tcp_hdr *hdr);
+
+// Captura dos cabeçalhos das requisições do httpd (http_headers.c)
+err_t http_headers_inpacket(struct tcp_pcb *pcb, struct pbuf *p);
+
+// Cópia com checksum pré-calculado do conteúdo embutido (http_chksum.c)
+u16_t http_chksum_copy(void *dst, const void *src, u16_t len);
+
+#endif // LWIP_HOOKS_H
@@ -18,6 +18,13 @@
 #ifndef _LWIPOPTS_H
 #define _LWIPOPTS_H
 
+// Perfil de memória (opção PICO_HTTPD_LWIP_PROFILE do CMake): o
+// lwipopts_probe.h da medição ou um perfil gerado por tools/lwip_profile.py.
+// Os valores dele têm precedência sobre os padrões abaixo.
+#ifdef LWIPOPTS_PROFILE
+#include LWIPOPTS_PROFILE
+#endif
+
 // ===== Sistema =====
 #ifndef NO_SYS
 #define NO_SYS                      1
@@ -35,34 +42,44 @@
 #endif
 #define MEM_ALIGNMENT               4
 
-// Calculado para suportar:
-// - 12 conexões TCP simultâneas (~250 bytes cada = 3000 bytes)
-// - Processamento SSI com 14 tags (~500 bytes por requisição)
-// - Buffer POST de 512 bytes para matrix.cgi
-// - Overhead de alocação dinâmica (~30%)
-// Total: ~14820 bytes, arredondado para 16000
+// Os tamanhos do heap e dos pools abaixo são estimativas de partida; um perfil
+// medido sob carga (tools/lwip_profile.py) os substitui
+#ifndef MEM_SIZE
 #define MEM_SIZE                    16000
+#endif
 
 // ===== TCP/IP Stack =====
 #define TCP_MSS                     1460
+// Limites por conexão, não reservas: os segmentos copiados saem do heap; os
+// do conteúdo embutido só ocupam o cabeçalho (ver "Envio sem cópia")
+#ifndef TCP_WND
 #define TCP_WND                     (8 * TCP_MSS)
+#endif
+#ifndef TCP_SND_BUF
 #define TCP_SND_BUF                 (8 * TCP_MSS)
+#endif
 #define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
 #define LWIP_TCP_KEEPALIVE          1
 
 // ===== Memory Pools =====
-// TCP segments na fila de saída
-// Calculado: (TCP_SND_BUF * 4 / TCP_MSS) para múltiplas conexões
+// TCP segments na fila de saída; o lwIP exige pelo menos TCP_SND_QUEUELEN
+#ifndef MEMP_NUM_TCP_SEG
 #define MEMP_NUM_TCP_SEG            40
+#endif
+// Também dimensiona os contextos de POST concorrentes do pico_httpd.c
+#ifndef MEMP_NUM_TCP_PCB
 #define MEMP_NUM_TCP_PCB            12
+#endif
+#ifndef MEMP_NUM_ARP_QUEUE
 #define MEMP_NUM_ARP_QUEUE          10
+#endif
 #define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 3 + 5)
 
-// Pool de pbufs para recepção/transmissão
-// Maior arquivo: index.shtml (11146 bytes) = 8 pbufs de 1460 bytes
-// Com múltiplas conexões: 8 × 3 conexões ativas = 24 mínimo
-// Aumentado para 32 para margem de segurança
+// Pool de pbufs da recepção (o driver do CYW43 aloca cada quadro aqui); o
+// lwIP exige que caiba uma janela TCP_WND inteira
+#ifndef PBUF_POOL_SIZE
 #define PBUF_POOL_SIZE              32
+#endif
 
 // ===== Protocolos =====
 #define LWIP_ARP                    1
@@ -81,7 +98,7 @@
 #define LWIP_NETIF_STATUS_CALLBACK  1
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
-#define LWIP_NETIF_TX_SINGLE_PBUF   1
+// LWIP_NETIF_TX_SINGLE_PBUF: ver "Envio sem cópia" abaixo
 
 // ===== DHCP =====
 #define DHCP_DOES_ARP_CHECK         0
@@ -100,6 +117,42 @@
 #define LWIP_HTTPD_SUPPORT_POST     1
 #define LWIP_HTTPD_SSI_INCLUDE_TAG  0
 #define HTTPD_FSDATA_FILE           "pico_fsdata.inc"
+// A varredura de tags SSI segue a flag FS_FILE_FLAGS_SSI de cada arquivo,
+// marcada por tools/makefsdata.py só onde há tags, e não a extensão
+#define LWIP_HTTPD_SSI_BY_FILE_EXTENSION 0
+// Arquivos dinâmicos (/api/state) gerados em fs_open_custom() no pico_httpd.c
+#define LWIP_HTTPD_CUSTOM_FILES     1
+// Leitura assíncrona para o stream SSE (/api/events): sem eventos a leitura
+// retorna FS_READ_DELAYED e o httpd aguarda o callback, sem polling
+#define LWIP_HTTPD_DYNAMIC_FILE_READ 1
+#define LWIP_HTTPD_FS_ASYNC_READ    1
+// Contexto por arquivo aberto (fs_state_init/fs_state_free): pedidos e
+// latência por URI no /metrics (ver http_metrics.h)
+#define LWIP_HTTPD_FILE_STATE       1
+// Falta de memória para o estado de uma conexão nova: o httpd a aborta em vez
+// de matar a conexão mais antiga, que pode ser um comando em andamento. A
+// falta de PCBs é tratada por classe em http_admission.h
+#define LWIP_HTTPD_KILL_OLD_ON_CONNECTIONS_EXCEEDED 0
+// Conexões persistentes para os arquivos com Content-Length (ver http_keepalive.h)
+#define LWIP_HTTPD_SUPPORT_11_KEEPALIVE 1
+// Conexão ociosa fechada depois deste tempo sem tráfego
+#define HTTP_KEEPALIVE_IDLE_S       10
+// Pedidos por conexão; o último sai sem keep-alive e a conexão é fechada
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+// O poll do httpd roda a cada segundo (ticks de 500 ms) e fecha a conexão
+// depois de HTTPD_MAX_RETRIES polls sem envio; o mesmo limite vale para uma
+// resposta parada à espera de ACK
+#define HTTPD_POLL_INTERVAL         2
+#define HTTPD_MAX_RETRIES           HTTP_KEEPALIVE_IDLE_S
+
+// ===== Hooks =====
+// O httpd não repassa os cabeçalhos da requisição; http_headers.c os lê dos
+// segmentos TCP da porta do httpd antes do callback de recepção e anota a
+// classe de cada pedido. Antes dele, num SYN, http_admission.c decide com os
+// PCBs esgotados que conexão cede o lugar (ERR_ABRT descarta o SYN)
+#define LWIP_HOOK_FILENAME          "lwip_hooks.h"
+#define LWIP_HOOK_TCP_INPACKET_PCB(pcb, hdr, optlen, opt1len, opt2, p) \
+        (http_admission_inpacket(pcb, hdr) == ERR_OK ? http_headers_inpacket(pcb, p) : ERR_ABRT)
 
 // ===== HTTP Server Memory Tuning =====
 // Tamanho máximo de inserção SSI (para tags grandes como "table")
@@ -112,17 +165,55 @@
 #define LWIP_HTTPD_POST_MAX_PAYLOAD_LEN     512
 // Buffer para URI de resposta POST
 #define LWIP_HTTPD_POST_MAX_RESPONSE_URI_LEN 64
+// Checksums TCP do conteúdo estático pré-calculados por tools/makefsdata.py
+// (opção PICO_HTTPD_PRECALC_CHECKSUM do CMake, ver http_chksum.h)
+#ifndef HTTPD_PRECALCULATED_CHECKSUM
 #define HTTPD_PRECALCULATED_CHECKSUM        0
+#endif
+#if HTTPD_PRECALCULATED_CHECKSUM
+// Checksum calculado durante a cópia para o segmento; a cópia consulta a
+// tabela de blocos do fsdata antes de somar os bytes
+#define LWIP_CHECKSUM_ON_COPY               1
+#define LWIP_CHKSUM_COPY(dst, src, len)     http_chksum_copy(dst, src, len)
+#endif
+
+// ===== Envio sem cópia =====
+// O conteúdo do fsdata vai da flash (XIP) para o tcp_write() sem
+// TCP_WRITE_FLAG_COPY: o segmento referencia a flash num PBUF_ROM e só o
+// cabeçalho sai do heap (ver http_zerocopy.h). Respostas na RAM são
+// copiadas. Os checksums pré-calculados só valem para dados copiados, então
+// HTTPD_PRECALCULATED_CHECKSUM mantém o envio com cópia.
+#ifndef HTTPD_ZERO_COPY
+#define HTTPD_ZERO_COPY                     (!HTTPD_PRECALCULATED_CHECKSUM)
+#endif
+#if HTTPD_ZERO_COPY
+// Endereço na janela XIP da flash do RP2040 (0x10000000-0x13ffffff)
+#ifndef HTTP_ROM_DATA
+#define HTTP_ROM_DATA(p)                    (((uintptr_t)(p) >> 26) == (0x10000000u >> 26))
+#endif
+#define HTTP_IS_DATA_VOLATILE(hs)           (HTTP_ROM_DATA((hs)->file) ? 0 : TCP_WRITE_FLAG_COPY)
+// Com cadeias de pbufs na saída; o driver do CYW43 as copia para o SPI
+#define LWIP_NETIF_TX_SINGLE_PBUF           0
+// Um PBUF_ROM por segmento do conteúdo embutido na fila de envio
+#ifndef MEMP_NUM_PBUF
+#define MEMP_NUM_PBUF                       MEMP_NUM_TCP_SEG
+#endif
+#else
+// O lwIP copia tudo para um único pbuf por segmento
+#define LWIP_NETIF_TX_SINGLE_PBUF           1
+#endif
 
 // ===== Estatísticas =====
-#define MEM_STATS                   0
+// Uso, máximo e falhas do heap e dos pools também em produção: expostos em
+// /metrics (ver http_metrics.h); cada alocação soma um contador
+#define LWIP_STATS                  1
+#define MEM_STATS                   1
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEMP_STATS                  1
 #define LINK_STATS                  0
 
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
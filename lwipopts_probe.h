@@ -0,0 +1,33 @@
+/**
+ * @file    lwipopts_probe.h
+ * @brief   Perfil de medição de memória do lwIP
+ * @details Usado com -DPICO_HTTPD_LWIP_PROFILE=lwipopts_probe.h. Folga acima
+ *          dos valores de lwipopts.h para que, sob carga, o máximo de cada
+ *          pool e do heap seja a demanda real e não o limite configurado. Um
+ *          pool que bate no teto (máximo igual ao tamanho ou "err" diferente
+ *          de zero) invalida a medição: tools/lwip_profile.py recusa a
+ *          gravação e o valor daqui tem de subir.
+ *
+ *          Cabe na placa (cerca de 48 KB além do firmware normal), mas não é
+ *          para produção: o perfil gerado a partir desta medição é.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef LWIPOPTS_PROBE_H
+#define LWIPOPTS_PROBE_H
+
+#define MEM_SIZE                    48000
+
+#define MEMP_NUM_TCP_PCB            16
+#define MEMP_NUM_TCP_PCB_LISTEN     8
+#define MEMP_NUM_TCP_SEG            128
+#define MEMP_NUM_UDP_PCB            8
+#define MEMP_NUM_PBUF               128
+#define MEMP_NUM_ARP_QUEUE          20
+#define PBUF_POOL_SIZE              40
+
+#endif // LWIPOPTS_PROBE_H
@@ -23,7 +23,9 @@
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
+#include "hardware/sync.h"
 #include <hardware/timer.h>
+#include <stdlib.h>
 
 // Define o nível de log em tempo de compilação (3 = todos os níveis ativos)
 #define LOG_LEVEL 3
@@ -33,12 +35,48 @@
 #include "lwip/apps/mdns.h"
 #include "lwip/init.h"
 #include "lwip/apps/httpd.h"
+#include "lwip/apps/fs.h"
 
 // OLED Display
 #include "oled.h"
 
 // WS2812 LED Matrix
 #include "neopixel_pio.h"
+#include "neopixel_effects.h"
+
+// Buzzers (non-blocking tone sequencer)
+#include "buzzer.h"
+
+// Background input sampling (buttons, joystick, temperature)
+#include "input_sampler.h"
+
+// Server-Sent Events stream (/api/events)
+#include "http_sse.h"
+
+// WebSocket control channel (ws://<board>:8080/ws)
+#include "ws_server.h"
+
+// CGI route and parameter dispatch (perfect-hash tables from http_routes.def)
+#include "http_route.h"
+
+// ETag / 304 Not Modified for the embedded content and /api/state
+#include "http_headers.h"
+#include "http_cache.h"
+
+// Accept-Encoding negotiation between the stored variants of a file
+#include "http_encoding.h"
+
+// Precalculated TCP checksums for the embedded content (optional)
+#include "http_chksum.h"
+
+// Embedded content sent straight from flash (PBUF_ROM)
+#include "http_zerocopy.h"
+
+// HTTP/1.1 persistent connections
+#include "http_keepalive.h"
+
+// Prometheus-style /metrics (lwIP pools, per-URI latency, peripheral timings)
+#include "http_metrics.h"
 
 void httpd_init(void);
 
@@ -63,21 +101,15 @@ void httpd_init(void);
 #define BUZZER_LEFT_PIN     21
 #define BUZZER_RIGHT_PIN    10
 
+// Background sampling period for buttons, joystick and temperature
+#define INPUT_SAMPLE_PERIOD_MS  20
+
 // ===== Global State Variables =====
 static absolute_time_t wifi_connected_time;
 static bool led_on = false;
 
-// Button states (true = pressed, active LOW)
-static volatile bool btn_a_pressed = false;
-static volatile bool btn_b_pressed = false;
-static volatile bool joy_btn_pressed = false;
-
-// Joystick ADC values
-static volatile uint16_t joystick_x = 2048;
-static volatile uint16_t joystick_y = 2048;
-
-// Temperature reading
-static volatile float chip_temperature = 0.0f;
+// Buttons, joystick and temperature are sampled in the background by
+// input_sampler; readers copy its snapshot with input_sampler_read()
 
 // RGB LED values (0-255)
 static uint8_t rgb_r = 0;
@@ -94,6 +126,44 @@ static uint16_t buzzer_duration = 100;
 static char oled_lines[OLED_MAX_LINES][OLED_MAX_CHARS];
 static int oled_current_line = 0;
 
+// Lines queued from the network context; the I2C transfer is done by the main loop
+static char oled_pending[OLED_MAX_LINES][OLED_MAX_CHARS];
+static uint8_t oled_pending_head = 0;
+static uint8_t oled_pending_count = 0;
+
+// Set when a bitmap upload is ready to be copied into the framebuffer and sent
+static volatile bool oled_render_pending = false;
+
+// 1bpp bitmap upload: 16 bytes per row, most significant bit = leftmost pixel
+#define OLED_BITMAP_WIDTH   128
+#define OLED_BITMAP_HEIGHT  64
+#define OLED_BITMAP_BYTES   (OLED_BITMAP_WIDTH * OLED_BITMAP_HEIGHT / 8)
+
+// Uploads are decoded into a back buffer owned by the request; the main loop
+// copies the finished one into the framebuffer, which the network context
+// never touches. One buffer can be filling while another is being shown.
+#define OLED_BITMAP_BUFFERS 2
+
+typedef enum {
+    OLED_BITMAP_FREE = 0,
+    OLED_BITMAP_FILLING,    // owned by a request (network context)
+    OLED_BITMAP_READY,      // complete, waiting for the main loop
+    OLED_BITMAP_SHOWING     // being copied by the main loop
+} oled_bitmap_state_t;
+
+static uint8_t oled_bitmap_buf[OLED_BITMAP_BUFFERS][OLED_BITMAP_BYTES];
+static uint16_t oled_bitmap_len[OLED_BITMAP_BUFFERS];
+static volatile uint8_t oled_bitmap_state[OLED_BITMAP_BUFFERS];
+
+// Device state version: bumped each time a CGI/POST request or WebSocket
+// command has changed an output (RGB, matrix, OLED, buzzer, LED) and when the
+// inputs published by /api/state change. Reported by the JSON ack and used
+// as the ETag of /api/state, so unchanged polls are answered with a 304.
+static uint32_t state_version = 1;
+
+// Main loop period (also the worst-case delay of a deferred OLED update)
+#define MAIN_LOOP_PERIOD_MS 10
+
 // ===== Hardware Initialization Functions =====
 
 static void init_buttons(void) {
@@ -156,7 +226,11 @@ static void init_rgb_led(void) {
     LOG_DEBUG("LED RGB inicializado (R:%d, G:%d, B:%d)", LED_R_PIN, LED_G_PIN, LED_B_PIN);
 }
 
-static void set_rgb_led(uint8_t r, uint8_t g, uint8_t b) {
+// Returns false when the LED already shows that colour
+static bool set_rgb_led(uint8_t r, uint8_t g, uint8_t b) {
+    if (r == rgb_r && g == rgb_g && b == rgb_b) {
+        return false;
+    }
     // Direct PWM values for common cathode LED (higher value = brighter)
     pwm_set_gpio_level(LED_R_PIN, r);
     pwm_set_gpio_level(LED_G_PIN, g);
@@ -164,104 +238,127 @@ static void set_rgb_led(uint8_t r, uint8_t g, uint8_t b) {
     rgb_r = r;
     rgb_g = g;
     rgb_b = b;
+    return true;
 }
 
 static void init_buzzer(void) {
-    // Initialize both buzzer pins as PWM
-    gpio_set_function(BUZZER_LEFT_PIN, GPIO_FUNC_PWM);
-    gpio_set_function(BUZZER_RIGHT_PIN, GPIO_FUNC_PWM);
-    
-    uint slice_left = pwm_gpio_to_slice_num(BUZZER_LEFT_PIN);
-    uint slice_right = pwm_gpio_to_slice_num(BUZZER_RIGHT_PIN);
-    
-    // Initialize with buzzer off
-    pwm_set_enabled(slice_left, false);
-    pwm_set_enabled(slice_right, false);
+    // Both buzzers are PWM outputs driven by the alarm-based tone sequencer
+    buzzer_init(BUZZER_LEFT_PIN, BUZZER_RIGHT_PIN);
     
     LOG_DEBUG("Buzzers inicializados (Esq:%d, Dir:%d)", BUZZER_LEFT_PIN, BUZZER_RIGHT_PIN);
 }
 
 // Channel: 0=both, 1=left, 2=right
-static void buzzer_play(uint16_t freq, uint16_t duration_ms, uint8_t channel) {
-    uint slice_left = pwm_gpio_to_slice_num(BUZZER_LEFT_PIN);
-    uint slice_right = pwm_gpio_to_slice_num(BUZZER_RIGHT_PIN);
-    
-    // freq == 0 turns off the buzzer(s)
+// Enqueues the tone and returns immediately; freq == 0 stops the channel(s).
+// Returns false when the note was dropped (queue full)
+static bool buzzer_play(uint16_t freq, uint16_t duration_ms, uint8_t channel) {
+    uint32_t start = time_us_32();
+    bool played = true;
     if (freq == 0) {
-        if (channel == 0 || channel == 1) {
-            pwm_set_enabled(slice_left, false);
-            pwm_set_gpio_level(BUZZER_LEFT_PIN, 0);
-        }
-        if (channel == 0 || channel == 2) {
-            pwm_set_enabled(slice_right, false);
-            pwm_set_gpio_level(BUZZER_RIGHT_PIN, 0);
-        }
+        buzzer_stop((buzzer_channel_t)channel);
         LOG_DEBUG("Buzzer[%d]: OFF", channel);
-        return;
+    } else if (!buzzer_tone((buzzer_channel_t)channel, freq, duration_ms)) {
+        LOG_WARN("Buzzer[%d]: fila cheia, nota descartada", channel);
+        played = false;
+    } else {
+        LOG_DEBUG("Buzzer[%d]: freq=%dHz, dur=%dms (fila=%u)", channel, freq, duration_ms,
+                  buzzer_queue_depth((buzzer_channel_t)channel));
     }
-    
-    // Configure PWM for desired frequency
-    // PWM clock is 125MHz, we want 50% duty cycle
-    uint32_t clock_freq = 125000000;
-    uint32_t divider = clock_freq / (freq * 4096); // 4096 = max wrap value
-    if (divider < 1) divider = 1;
-    if (divider > 255) divider = 255;
-    
-    uint32_t wrap = clock_freq / (divider * freq) - 1;
-    if (wrap > 65535) wrap = 65535;
-    
-    bool play_left = (channel == 0 || channel == 1);
-    bool play_right = (channel == 0 || channel == 2);
-    
-    if (play_left) {
-        pwm_set_clkdiv(slice_left, (float)divider);
-        pwm_set_wrap(slice_left, wrap);
-        pwm_set_gpio_level(BUZZER_LEFT_PIN, wrap / 2);
-        pwm_set_enabled(slice_left, true);
-    }
-    
-    if (play_right) {
-        pwm_set_clkdiv(slice_right, (float)divider);
-        pwm_set_wrap(slice_right, wrap);
-        pwm_set_gpio_level(BUZZER_RIGHT_PIN, wrap / 2);
-        pwm_set_enabled(slice_right, true);
-    }
-    
-    busy_wait_ms(duration_ms);
-    
-    // Turn off buzzers
-    if (play_left) {
-        pwm_set_enabled(slice_left, false);
-        pwm_set_gpio_level(BUZZER_LEFT_PIN, 0);
+    http_metrics_op(HTTP_METRICS_OP_BUZZER_PLAY, start);
+    return played;
+}
+
+// Incremental parser for comma-separated note sequences (already URL decoded):
+//   "440:200"      tone of 440 Hz for 200 ms
+//   "0:100"        rest of 100 ms
+//   "200-2000:500" linear sweep from 200 Hz to 2000 Hz in 500 ms
+// Each note is enqueued as soon as its token ends, so a sequence can be fed
+// in pieces of any size and is bounded only by the buzzer queue.
+typedef struct {
+    uint32_t value[3];      // freq, freq_end, duration
+    uint8_t field;          // Field being read (index into value)
+    bool digits;            // Current field has at least one digit
+    bool bad;               // Current token is malformed
+    uint8_t channel;
+    uint16_t parsed;
+    uint16_t accepted;
+} buzzer_seq_t;
+
+static void buzzer_seq_reset_token(buzzer_seq_t *s) {
+    memset(s->value, 0, sizeof(s->value));
+    s->field = 0;
+    s->digits = false;
+    s->bad = false;
+}
+
+static void buzzer_seq_begin(buzzer_seq_t *s, uint8_t channel) {
+    memset(s, 0, sizeof(*s));
+    s->channel = channel;
+}
+
+static void buzzer_seq_token_end(buzzer_seq_t *s) {
+    if (s->field == 2 && s->digits && !s->bad) {
+        buzzer_note_t note = {
+            .kind = s->value[1] ? BUZZER_NOTE_SWEEP : BUZZER_NOTE_TONE,
+            .freq = (uint16_t)s->value[0],
+            .freq_end = (uint16_t)(s->value[1] ? s->value[1] : s->value[0]),
+            .duration_ms = (uint16_t)s->value[2],
+        };
+        if (note.freq == 0) {
+            note.kind = BUZZER_NOTE_REST;
+        }
+        s->parsed++;
+        if (buzzer_enqueue((buzzer_channel_t)s->channel, &note)) {
+            s->accepted++;
+        }
     }
-    if (play_right) {
-        pwm_set_enabled(slice_right, false);
-        pwm_set_gpio_level(BUZZER_RIGHT_PIN, 0);
+    buzzer_seq_reset_token(s);
+}
+
+static void buzzer_seq_feed(buzzer_seq_t *s, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c >= '0' && c <= '9') {
+            if (s->value[s->field] < 65535) {
+                s->value[s->field] = s->value[s->field] * 10 + (c - '0');
+            }
+            s->digits = true;
+        } else if (c == '-' && s->field == 0) {
+            s->field = 1;
+            s->digits = false;
+        } else if (c == ':' && s->field < 2) {
+            s->field = 2;
+            s->digits = false;
+        } else if (c == ',') {
+            buzzer_seq_token_end(s);
+        } else if (c != ' ') {
+            s->bad = true;
+        }
     }
-    
-    LOG_DEBUG("Buzzer[%d]: freq=%dHz, dur=%dms", channel, freq, duration_ms);
 }
 
-static void read_inputs(void) {
-    // Read buttons (active LOW)
-    btn_a_pressed = !gpio_get(BTN_A_PIN);
-    btn_b_pressed = !gpio_get(BTN_B_PIN);
-    joy_btn_pressed = !gpio_get(JOYSTICK_BTN_PIN);
-    
-    // Read joystick ADC
-    adc_select_input(JOYSTICK_X_ADC);
-    joystick_x = adc_read();
-    
-    adc_select_input(JOYSTICK_Y_ADC);
-    joystick_y = adc_read();
-    
-    // Read internal temperature sensor (ADC channel 4)
-    adc_select_input(TEMP_ADC_CHANNEL);
-    uint16_t raw_temp = adc_read();
-    // Convert ADC reading to temperature in Celsius
-    // Formula from RP2040 datasheet: T = 27 - (ADC_voltage - 0.706) / 0.001721
-    float voltage = raw_temp * 3.3f / 4096.0f;
-    chip_temperature = 27.0f - (voltage - 0.706f) / 0.001721f;
+static uint16_t buzzer_seq_end(buzzer_seq_t *s) {
+    buzzer_seq_token_end(s);
+    LOG_DEBUG("Buzzer[%d]: sequencia %d/%d notas (fila=%u, descartadas=%lu)", s->channel, s->accepted, s->parsed,
+              buzzer_queue_depth((buzzer_channel_t)s->channel), (unsigned long)buzzer_dropped_count());
+    return s->accepted;
+}
+
+static void init_inputs(void) {
+    const input_sampler_config_t config = {
+        .btn_a_pin = BTN_A_PIN,
+        .btn_b_pin = BTN_B_PIN,
+        .joy_btn_pin = JOYSTICK_BTN_PIN,
+        .joy_x_adc = JOYSTICK_X_ADC,
+        .joy_y_adc = JOYSTICK_Y_ADC,
+        .temp_adc = TEMP_ADC_CHANNEL,
+        .period_ms = INPUT_SAMPLE_PERIOD_MS,
+    };
+    if (!input_sampler_init(&config)) {
+        LOG_WARN("Falha ao iniciar amostragem das entradas!");
+        return;
+    }
+    LOG_DEBUG("Amostragem de entradas iniciada (%d ms)", INPUT_SAMPLE_PERIOD_MS);
 }
 
 static void oled_push_line(const char *text) {
@@ -279,22 +376,95 @@ static void oled_push_line(const char *text) {
     for (int i = 0; i < OLED_MAX_LINES; i++) {
         oled_set_text_line(i, oled_lines[i], OLED_ALIGN_LEFT);
     }
+    uint32_t start = time_us_32();
     oled_render_text();
+    http_metrics_op(HTTP_METRICS_OP_OLED_RENDER, start);
     
     LOG_DEBUG("OLED: %s", text);
 }
 
+// Queue a line for the OLED without touching I2C; dropped when the queue is full
+static bool oled_defer_line(const char *text) {
+    bool queued = false;
+    uint32_t irq = save_and_disable_interrupts();
+    if (oled_pending_count < OLED_MAX_LINES) {
+        char *dst = oled_pending[(oled_pending_head + oled_pending_count) % OLED_MAX_LINES];
+        strncpy(dst, text, OLED_MAX_CHARS - 1);
+        dst[OLED_MAX_CHARS - 1] = '\0';
+        oled_pending_count++;
+        queued = true;
+    }
+    restore_interrupts(irq);
+    return queued;
+}
+
+// Copy the last completed bitmap into the framebuffer and send it
+static void oled_bitmap_show(void) {
+    int ready = -1;
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < OLED_BITMAP_BUFFERS; i++) {
+        if (oled_bitmap_state[i] == OLED_BITMAP_READY) {
+            oled_bitmap_state[i] = OLED_BITMAP_SHOWING;
+            ready = i;
+            break;
+        }
+    }
+    restore_interrupts(irq);
+    if (ready < 0) {
+        return;
+    }
+
+    // Bytes the upload did not reach keep what is on the display
+    const uint8_t *src = oled_bitmap_buf[ready];
+    for (uint16_t n = 0; n < oled_bitmap_len[ready]; n++) {
+        int x = (n % (OLED_BITMAP_WIDTH / 8)) * 8;
+        int y = n / (OLED_BITMAP_WIDTH / 8);
+        for (int bit = 0; bit < 8; bit++) {
+            oled_set_pixel(x + bit, y, src[n] & (0x80 >> bit));
+        }
+    }
+    uint32_t start = time_us_32();
+    oled_render();
+    http_metrics_op(HTTP_METRICS_OP_OLED_RENDER, start);
+    oled_bitmap_state[ready] = OLED_BITMAP_FREE;
+}
+
+// Render lines queued by oled_defer_line(); called from the main loop
+static void oled_flush_pending(void) {
+    char line[OLED_MAX_CHARS];
+    while (oled_pending_count > 0) {
+        uint32_t irq = save_and_disable_interrupts();
+        memcpy(line, oled_pending[oled_pending_head], OLED_MAX_CHARS);
+        oled_pending_head = (oled_pending_head + 1) % OLED_MAX_LINES;
+        oled_pending_count--;
+        restore_interrupts(irq);
+        oled_push_line(line);
+    }
+    if (oled_render_pending) {
+        oled_render_pending = false;
+        oled_bitmap_show();
+    }
+}
+
 static void init_bitdoglab_matrix(void) {
     npInit(NEOPIXEL_PIN);
     LOG_DEBUG("Matriz LED BitDogLab inicializada (GPIO:%d, LEDs:%d)", NEOPIXEL_PIN, NEOPIXEL_NUM_LEDS);
 }
 
+// Start the DMA transfer of the frame, timed for /metrics
+static void matrix_write(void) {
+    uint32_t start = time_us_32();
+    npWriteAsync();
+    http_metrics_op(HTTP_METRICS_OP_NP_WRITE, start);
+}
+
 
 static void init_bitdoglab_hardware(void) {
     LOG_INFO("Inicializando hardware BitDogLab...");
     
     init_buttons();
     init_adc();
+    init_inputs();
     init_rgb_led();
     init_buzzer();
     init_bitdoglab_matrix();
@@ -354,31 +524,6 @@ static int hex_to_int(char c) {
     return -1;
 }
 
-// Full URL decode in-place
-static void url_decode(char *str) {
-    char *src = str;
-    char *dst = str;
-    
-    while (*src) {
-        if (*src == '+') {
-            *dst++ = ' ';
-            src++;
-        } else if (*src == '%' && src[1] && src[2]) {
-            int h1 = hex_to_int(src[1]);
-            int h2 = hex_to_int(src[2]);
-            if (h1 >= 0 && h2 >= 0) {
-                *dst++ = (char)((h1 << 4) | h2);
-                src += 3;
-            } else {
-                *dst++ = *src++;
-            }
-        } else {
-            *dst++ = *src++;
-        }
-    }
-    *dst = '\0';
-}
-
 // Remove accents from UTF-8 text (convert to ASCII equivalent)
 // Handles common Portuguese/Spanish accents
 static void remove_accents(char *str) {
@@ -457,113 +602,495 @@ static void remove_accents(char *str) {
     *dst = '\0';
 }
 
-static const char *cgi_handler_index(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
-    return "/index.shtml";
-}
+// ===== WebSocket control channel =====
+// Binary frames; the first byte selects the command:
+//   0x01 matrix  75 bytes, R,G,B per LED in hardware order (already flipped)
+//   0x02 rgb     3 bytes, R,G,B
+//   0x03 oled    1..16 bytes of UTF-8 text (one line)
+//   0x04 buzzer  freq (u16 LE), duration ms (u16 LE), channel (u8); freq 0 stops
+// Runs in the lwIP context, so every command only touches non-blocking
+// APIs (DMA matrix write, PWM registers, buzzer queue, deferred OLED).
+#define WS_CMD_MATRIX   0x01
+#define WS_CMD_RGB      0x02
+#define WS_CMD_OLED     0x03
+#define WS_CMD_BUZZER   0x04
 
-// CGI handler for RGB LED control
-static const char *cgi_handler_rgb(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
-    uint8_t r = 0, g = 0, b = 0;
+static void ws_command_handler(const uint8_t *data, size_t len) {
+    if (len < 1) {
+        return;
+    }
+    const uint8_t *arg = data + 1;
+    size_t arg_len = len - 1;
     
-    for (int i = 0; i < iNumParams; i++) {
-        if (strcmp(pcParam[i], "r") == 0) {
-            r = (uint8_t)atoi(pcValue[i]);
-        } else if (strcmp(pcParam[i], "g") == 0) {
-            g = (uint8_t)atoi(pcValue[i]);
-        } else if (strcmp(pcParam[i], "b") == 0) {
-            b = (uint8_t)atoi(pcValue[i]);
+    switch (data[0]) {
+        case WS_CMD_MATRIX: {
+            if (arg_len != NEOPIXEL_NUM_LEDS * 3) {
+                return;
+            }
+            npEffectStop(false);
+            for (int i = 0; i < NEOPIXEL_NUM_LEDS; i++) {
+                npSetLED(i, arg[i * 3], arg[i * 3 + 1], arg[i * 3 + 2]);
+            }
+            matrix_write();
+            break;
+        }
+        case WS_CMD_RGB: {
+            if (arg_len != 3) {
+                return;
+            }
+            if (!set_rgb_led(arg[0], arg[1], arg[2])) {
+                return;
+            }
+            break;
+        }
+        case WS_CMD_OLED: {
+            // UTF-8 input can be up to 4 bytes per character before remove_accents()
+            char text[OLED_MAX_CHARS * 4];
+            if (arg_len == 0 || arg_len >= sizeof(text)) {
+                return;
+            }
+            memcpy(text, arg, arg_len);
+            text[arg_len] = '\0';
+            remove_accents(text);
+            text[OLED_MAX_CHARS - 1] = '\0';
+            if (!oled_defer_line(text)) {
+                LOG_WARN("[WS] Fila do OLED cheia, texto descartado");
+                return;
+            }
+            break;
+        }
+        case WS_CMD_BUZZER: {
+            if (arg_len != 5) {
+                return;
+            }
+            uint16_t freq = (uint16_t)(arg[0] | arg[1] << 8);
+            uint16_t dur = (uint16_t)(arg[2] | arg[3] << 8);
+            if (!buzzer_play(freq, dur, arg[4] <= BUZZER_CH_RIGHT ? arg[4] : BUZZER_CH_BOTH)) {
+                return;
+            }
+            break;
         }
+        default:
+            return;
     }
-    
-    set_rgb_led(r, g, b);
-    LOG_DEBUG("RGB LED: R=%d, G=%d, B=%d", r, g, b);
-    
-    return "/index.shtml";
+    state_version++;
 }
 
-// CGI handler for OLED text
-static const char *cgi_handler_oled(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
-    for (int i = 0; i < iNumParams; i++) {
-        if (strcmp(pcParam[i], "text") == 0) {
-            // Decode URL and remove accents for OLED display
-            url_decode(pcValue[i]);
-            remove_accents(pcValue[i]);
-            pcValue[i][OLED_MAX_CHARS] = '\0';
-            oled_push_line(pcValue[i]);
+// ===== CGI routes (GET query strings and POST bodies) =====
+// Routes and their typed parameters are declared in http_routes.def; the
+// generated perfect-hash tables resolve the URI and every key with one hash
+// and one comparison, and the handlers below receive decoded values
+// (numbers, enum indexes, colours, text or stream chunks). GET and POST go
+// through the same tokenizer and the same handlers.
+
+// Incremental hex bitmap decoder writing into a back buffer (see
+// oled_bitmap_show()); bytes beyond the display are ignored
+typedef struct {
+    uint16_t byte_index;
+    uint8_t nibbles;
+    uint8_t cur;
+    uint8_t buf;                // back buffer index + 1, 0 = none
+    bool dropped;               // no free back buffer for this upload
+} oled_bitmap_t;
+
+static bool oled_bitmap_claim(oled_bitmap_t *bm) {
+    uint32_t irq = save_and_disable_interrupts();
+    for (int i = 0; i < OLED_BITMAP_BUFFERS; i++) {
+        if (oled_bitmap_state[i] == OLED_BITMAP_FREE) {
+            oled_bitmap_state[i] = OLED_BITMAP_FILLING;
+            bm->buf = (uint8_t)(i + 1);
             break;
         }
     }
-    return "/index.shtml";
+    restore_interrupts(irq);
+    return bm->buf != 0;
 }
 
-// CGI handler for LED Matrix
-static const char *cgi_handler_matrix(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
-    for (int i = 0; i < iNumParams; i++) {
-        if (strcmp(pcParam[i], "data") == 0) {
-            // URL decode first (commas are encoded as %2C)
-            url_decode(pcValue[i]);
-            // Parse comma-separated hex colors
-            char *data = pcValue[i];
-            int led_index = 0;
-            char *token = strtok(data, ",");
-            
-            while (token != NULL && led_index < NEOPIXEL_NUM_LEDS) {
-                // Convert hex string to uint32
-                uint32_t color = (uint32_t)strtoul(token, NULL, 16);
-                // Extract RGB components from hex
-                uint8_t r = (color >> 16) & 0xFF;
-                uint8_t g = (color >> 8) & 0xFF;
-                uint8_t b = color & 0xFF;
-                npSetLED(led_index, r, g, b);
-                led_index++;
-                
-            }
-            LOG_DEBUG("LED Matrix updated, %d LEDs", led_index);
-            npWrite();
-            break;
+// Hand the decoded bitmap to the main loop; an older one still waiting is
+// superseded
+static void oled_bitmap_publish(oled_bitmap_t *bm) {
+    int i = bm->buf - 1;
+    uint32_t irq = save_and_disable_interrupts();
+    for (int j = 0; j < OLED_BITMAP_BUFFERS; j++) {
+        if (oled_bitmap_state[j] == OLED_BITMAP_READY) {
+            oled_bitmap_state[j] = OLED_BITMAP_FREE;
         }
     }
-    return "/index.shtml";
+    oled_bitmap_len[i] = bm->byte_index;
+    oled_bitmap_state[i] = OLED_BITMAP_READY;
+    restore_interrupts(irq);
+    bm->buf = 0;
+    oled_render_pending = true;
 }
 
-// CGI handler for Buzzer control
-static const char *cgi_handler_buzzer(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
-    uint16_t freq = 1000;
-    uint16_t duration = 100;
-    uint8_t channel = 0; // 0=both, 1=left, 2=right
-    
-    for (int i = 0; i < iNumParams; i++) {
-        if (strcmp(pcParam[i], "freq") == 0) {
-            freq = (uint16_t)atoi(pcValue[i]);
-        } else if (strcmp(pcParam[i], "dur") == 0) {
-            duration = (uint16_t)atoi(pcValue[i]);
-        } else if (strcmp(pcParam[i], "ch") == 0) {
-            if (strcmp(pcValue[i], "left") == 0) channel = 1;
-            else if (strcmp(pcValue[i], "right") == 0) channel = 2;
-            else channel = 0; // both
+// Request ended without a complete upload
+static void oled_bitmap_release(oled_bitmap_t *bm) {
+    if (bm->buf != 0) {
+        oled_bitmap_state[bm->buf - 1] = OLED_BITMAP_FREE;
+        bm->buf = 0;
+    }
+}
+
+static void oled_bitmap_feed(oled_bitmap_t *bm, const char *data, size_t len) {
+    if (bm->buf == 0) {
+        if (bm->dropped) {
+            return;
+        }
+        if (!oled_bitmap_claim(bm)) {
+            LOG_WARN("[HTTP] Sem buffer livre para o bitmap do OLED, upload descartado");
+            bm->dropped = true;
+            return;
         }
     }
-    
-    // Limit values for safety
-    if (freq > 10000) freq = 10000;
-    if (freq < 100) freq = 100;
-    if (duration > 2000) duration = 2000;
-    if (duration < 10) duration = 10;
-    
+    uint8_t *dst = oled_bitmap_buf[bm->buf - 1];
+    for (size_t i = 0; i < len && bm->byte_index < OLED_BITMAP_BYTES; i++) {
+        int v = hex_to_int(data[i]);
+        if (v < 0) {
+            continue; // separators are allowed
+        }
+        bm->cur = (uint8_t)(bm->cur << 4 | v);
+        if (++bm->nibbles < 2) {
+            continue;
+        }
+        dst[bm->byte_index++] = bm->cur;
+        bm->nibbles = 0;
+        bm->cur = 0;
+    }
+}
+
+// One context per request in flight. httpd may run a POST on every TCP
+// connection at once, so the POST pool matches the PCB pool; GET requests
+// are handled synchronously and share cgi_ctx.
+#define POST_CTX_COUNT          MEMP_NUM_TCP_PCB
+// A context whose connection died without httpd_post_finished() (e.g. a
+// reset reported through the TCP error callback) is reclaimed after this
+#define POST_CTX_TIMEOUT_MS     10000
+
+typedef struct post_ctx {
+    void *connection;           // httpd connection handle (NULL = free)
+    absolute_time_t started;
+    int body_left;              // Content-Length bytes not yet received
+    uint8_t route;              // http_route_id_t
+    char response_uri[LWIP_HTTPD_POST_MAX_RESPONSE_URI_LEN];
+    http_route_req_t req;
+    bool changed;               // a handler changed an output (bumps state_version)
+    // Values that are only applied once the whole request has been read
+    union {
+        struct {
+            uint8_t r, g, b;
+            uint8_t seen;       // bit 0..2 = r, g, b
+        } rgb;
+        struct {
+            uint16_t freq;
+            uint16_t dur;
+            uint8_t channel;
+            uint8_t given;      // bit 0 = freq, bit 1 = dur
+            bool stop;
+            bool seq_started;
+            buzzer_seq_t seq;
+        } buzzer;
+        struct {
+            bool started;
+            uint16_t speed;     // Interval between frames when data has several
+            uint16_t colors;
+            uint16_t dropped;   // Colours beyond NP_FX_MAX_FRAMES frames
+        } matrix;
+        oled_bitmap_t bitmap;
+        struct {
+            np_effect_params_t params;
+            bool has_fx, has_color, stop;
+        } fx;
+    } u;
+} post_ctx_t;
+
+typedef struct {
+    void (*on_value)(post_ctx_t *ctx, const http_value_t *v);
+    void (*on_finish)(post_ctx_t *ctx); // NULL when every value is applied as it arrives
+} route_handler_t;
+
+static void post_copy(char *dst, size_t dst_len, const char *src) {
+    strncpy(dst, src, dst_len - 1);
+    dst[dst_len - 1] = '\0';
+}
+
+// "/led.cgi": led_state=ON|OFF
+static void route_led_value(post_ctx_t *ctx, const http_value_t *v) {
+    if (v->key == HTTP_KEY_LED_STATE) {
+        bool on = (v->num == HTTP_LED_STATE_ON);
+        if (on != led_on) {
+            led_on = on;
+            cyw43_gpio_set(&cyw43_state, 0, led_on);
+            ctx->changed = true;
+        }
+    }
+}
+
+// "/rgb.cgi": r, g, b (0-255), applied together
+static void route_rgb_value(post_ctx_t *ctx, const http_value_t *v) {
+    switch (v->key) {
+        case HTTP_KEY_R: ctx->u.rgb.r = (uint8_t)v->num; ctx->u.rgb.seen |= 1; break;
+        case HTTP_KEY_G: ctx->u.rgb.g = (uint8_t)v->num; ctx->u.rgb.seen |= 2; break;
+        case HTTP_KEY_B: ctx->u.rgb.b = (uint8_t)v->num; ctx->u.rgb.seen |= 4; break;
+        default: break;
+    }
+}
+
+static void route_rgb_finish(post_ctx_t *ctx) {
+    if (ctx->u.rgb.seen == 7) {
+        ctx->changed = set_rgb_led(ctx->u.rgb.r, ctx->u.rgb.g, ctx->u.rgb.b);
+        LOG_DEBUG("RGB LED: R=%d, G=%d, B=%d", ctx->u.rgb.r, ctx->u.rgb.g, ctx->u.rgb.b);
+    }
+}
+
+// "/oled.cgi": text (one line); bmp=<hex> (1024 bytes, 128x64 1bpp) decoded
+// as it arrives and shown by the main loop once the value is complete
+static void route_oled_value(post_ctx_t *ctx, const http_value_t *v) {
+    if (v->key == HTTP_KEY_TEXT) {
+        // Remove accents (OLED doesn't support them); length is capped by the route table
+        remove_accents(v->text.str);
+        // I2C only runs in the main loop, same as the WebSocket command
+        if (oled_defer_line(v->text.str)) {
+            ctx->changed = true;
+        } else {
+            LOG_WARN("[HTTP] Fila do OLED cheia, texto descartado");
+        }
+    } else if (v->key == HTTP_KEY_BMP) {
+        if (!v->end) {
+            oled_bitmap_feed(&ctx->u.bitmap, v->chunk.data, v->chunk.len);
+        } else if (ctx->u.bitmap.buf != 0) {
+            LOG_DEBUG("OLED: bitmap de %u bytes", ctx->u.bitmap.byte_index);
+            oled_bitmap_publish(&ctx->u.bitmap); // I2C transfer happens in the main loop
+            ctx->changed = true;
+        }
+    }
+}
+
+static void route_oled_finish(post_ctx_t *ctx) {
+    oled_bitmap_release(&ctx->u.bitmap); // bmp value cut short
+}
+
+// "/matrix.cgi": data=RRGGBB,RRGGBB,... in hardware order. 25 colours are
+// one frame; more are played as an animation ("frames" effect) at "speed" ms.
+static void route_matrix_value(post_ctx_t *ctx, const http_value_t *v) {
+    if (v->key == HTTP_KEY_SPEED) {
+        ctx->u.matrix.speed = (uint16_t)v->num;
+        return;
+    }
+    if (!ctx->u.matrix.started) {
+        // A manual frame replaces any running effect
+        npEffectStop(false);
+        npFramesClear();
+        ctx->u.matrix.started = true;
+    }
+    if (v->end) {
+        return;
+    }
+    if (npFramesPush((v->color >> 16) & 0xFF, (v->color >> 8) & 0xFF, v->color & 0xFF)) {
+        ctx->u.matrix.colors++;
+    } else {
+        ctx->u.matrix.dropped++;
+    }
+}
+
+static void route_matrix_finish(post_ctx_t *ctx) {
+    if (!ctx->u.matrix.started) {
+        return;
+    }
+    ctx->changed = true;
+    uint frames = npFramesCount();
+    if (frames <= 1) {
+        npFramesShow(0);
+        matrix_write();
+        LOG_DEBUG("LED Matrix: %d LEDs updated", ctx->u.matrix.colors);
+        return;
+    }
+    np_effect_params_t params = { .effect = NP_FX_FRAMES, .interval_ms = ctx->u.matrix.speed };
+    npEffectStart(&params);
+    LOG_DEBUG("LED Matrix: animacao de %u quadros (%u cores descartadas)", frames, ctx->u.matrix.dropped);
+}
+
+// "/buzzer.cgi": freq, dur, ch (both|left|right, same order as
+// buzzer_channel_t), stop; seq=<notes> is streamed, each note enqueued as
+// soon as its token ends on the channel given so far ("ch" must come first)
+static void route_buzzer_value(post_ctx_t *ctx, const http_value_t *v) {
+    switch (v->key) {
+        case HTTP_KEY_FREQ:
+            ctx->u.buzzer.freq = (uint16_t)v->num;
+            ctx->u.buzzer.given |= 1;
+            break;
+        case HTTP_KEY_DUR:
+            ctx->u.buzzer.dur = (uint16_t)v->num;
+            ctx->u.buzzer.given |= 2;
+            break;
+        case HTTP_KEY_CH:
+            ctx->u.buzzer.channel = (uint8_t)v->num;
+            break;
+        case HTTP_KEY_STOP:
+            ctx->u.buzzer.stop = true;
+            break;
+        case HTTP_KEY_SEQ:
+            if (!ctx->u.buzzer.seq_started) {
+                buzzer_seq_begin(&ctx->u.buzzer.seq, ctx->u.buzzer.channel);
+                ctx->u.buzzer.seq_started = true;
+            }
+            if (!v->end) {
+                buzzer_seq_feed(&ctx->u.buzzer.seq, v->chunk.data, v->chunk.len);
+            } else {
+                buzzer_seq_end(&ctx->u.buzzer.seq);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void route_buzzer_finish(post_ctx_t *ctx) {
+    if (ctx->u.buzzer.stop) {
+        buzzer_play(0, 0, ctx->u.buzzer.channel);
+        ctx->changed = true;
+        return;
+    }
+    if (ctx->u.buzzer.seq_started) {
+        ctx->changed = ctx->u.buzzer.seq.accepted > 0;
+        return;
+    }
+    // A single tone; missing values keep the last ones used
+    uint16_t freq = (ctx->u.buzzer.given & 1) ? ctx->u.buzzer.freq : buzzer_freq;
+    uint16_t dur = (ctx->u.buzzer.given & 2) ? ctx->u.buzzer.dur : buzzer_duration;
+    if (freq > BUZZER_FREQ_MAX) freq = BUZZER_FREQ_MAX;
+    if (freq < BUZZER_FREQ_MIN) freq = BUZZER_FREQ_MIN;
+    if (dur > BUZZER_DURATION_MAX) dur = BUZZER_DURATION_MAX;
+    if (dur < BUZZER_DURATION_MIN) dur = BUZZER_DURATION_MIN;
     buzzer_freq = freq;
-    buzzer_duration = duration;
-    buzzer_play(freq, duration, channel);
-    
-    return "/index.shtml";
+    buzzer_duration = dur;
+    ctx->changed = buzzer_play(freq, dur, ctx->u.buzzer.channel);
+}
+
+// "/fx.cgi": start (or stop) an on-device matrix effect
+//   fx    effect name (NP_FX_LIST), e.g. "rainbow", "wave_down", "scroll"; the
+//         generated enum index is the np_effect_t, unknown names count as missing
+//   color base colour as RRGGBB hex (optional leading '#')
+//   speed frame interval in ms (0 = effect default)
+//   dur   total duration in ms (0 = until stopped)
+//   text  text for the "scroll" effect
+//   stop  stop the effect and clear the matrix (also when fx is missing)
+static void route_fx_value(post_ctx_t *ctx, const http_value_t *v) {
+    np_effect_params_t *p = &ctx->u.fx.params;
+    switch (v->key) {
+        case HTTP_KEY_FX:
+            p->effect = (np_effect_t)v->num;
+            ctx->u.fx.has_fx = true;
+            break;
+        case HTTP_KEY_COLOR:
+            if (!v->end && !ctx->u.fx.has_color) {
+                p->r = (v->color >> 16) & 0xFF;
+                p->g = (v->color >> 8) & 0xFF;
+                p->b = v->color & 0xFF;
+                ctx->u.fx.has_color = true;
+            }
+            break;
+        case HTTP_KEY_SPEED:
+            p->interval_ms = (uint16_t)v->num;
+            break;
+        case HTTP_KEY_DUR:
+            p->duration_ms = v->num;
+            break;
+        case HTTP_KEY_TEXT:
+            remove_accents(v->text.str);
+            post_copy(p->text, sizeof(p->text), v->text.str);
+            break;
+        case HTTP_KEY_STOP:
+            ctx->u.fx.stop = true;
+            break;
+        default:
+            break;
+    }
 }
 
-static tCGI cgi_handlers[] = {
+static void route_fx_finish(post_ctx_t *ctx) {
+    np_effect_params_t *p = &ctx->u.fx.params;
+    if (ctx->u.fx.stop || !ctx->u.fx.has_fx) {
+        npEffectStop(true);
+        ctx->changed = true;
+        LOG_DEBUG("Efeito da matriz parado");
+        return;
+    }
+    if (!ctx->u.fx.has_color) {
+        p->r = 255;
+    }
+    if (!npEffectStart(p)) {
+        LOG_WARN("Efeito indisponível ou sem timer livre: %s", npEffectName(p->effect));
+        return;
+    }
+    ctx->changed = true;
+    LOG_DEBUG("Efeito da matriz: %s (intervalo=%ums, dur=%lums)", npEffectName(p->effect),
+              p->interval_ms, (unsigned long)p->duration_ms);
+}
+
+static const route_handler_t route_handlers[HTTP_ROUTE_COUNT] = {
+    [HTTP_ROUTE_LED]    = { route_led_value,    NULL },
+    [HTTP_ROUTE_RGB]    = { route_rgb_value,    route_rgb_finish },
+    [HTTP_ROUTE_OLED]   = { route_oled_value,   route_oled_finish },
+    [HTTP_ROUTE_MATRIX] = { route_matrix_value, route_matrix_finish },
+    [HTTP_ROUTE_BUZZER] = { route_buzzer_value, route_buzzer_finish },
+    [HTTP_ROUTE_FX]     = { route_fx_value,     route_fx_finish },
+};
+
+static void route_value(void *arg, const http_value_t *v) {
+    post_ctx_t *ctx = (post_ctx_t *)arg;
+    route_handlers[ctx->route].on_value(ctx, v);
+}
+
+static void route_ctx_begin(post_ctx_t *ctx, uint route) {
+    memset(&ctx->u, 0, sizeof(ctx->u));
+    ctx->route = (uint8_t)route;
+    ctx->changed = false;
+    http_route_begin(&ctx->req, route, route_value, ctx);
+}
+
+// Request dropped before route_ctx_finish(): give back what the handlers hold
+static void route_ctx_abort(post_ctx_t *ctx) {
+    if (ctx->route == HTTP_ROUTE_OLED) {
+        oled_bitmap_release(&ctx->u.bitmap);
+    }
+}
+
+static void route_ctx_finish(post_ctx_t *ctx) {
+    // The last pair has no trailing '&'
+    http_route_finish(&ctx->req);
+    if (route_handlers[ctx->route].on_finish) {
+        route_handlers[ctx->route].on_finish(ctx);
+    }
+    // Rejected values, unknown keys and empty bodies leave the ETag alone
+    if (ctx->changed) {
+        state_version++;
+    }
+}
+
+static const char *cgi_handler_index(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
+    return "/index.html";
+}
+
+// Pages mapped to the index, followed by one entry per generated route
+#define CGI_FIRST_ROUTE 2
+
+static post_ctx_t cgi_ctx;
+
+// GET with a query string: httpd hands over the table index, so the route
+// is known without looking at the URI again
+static const char *cgi_handler_route(int iIndex, int iNumParams, char *pcParam[], char *pcValue[]) {
+    route_ctx_begin(&cgi_ctx, iIndex - CGI_FIRST_ROUTE);
+    http_route_feed_query(&cgi_ctx.req, iNumParams, pcParam, pcValue);
+    route_ctx_finish(&cgi_ctx);
+    return "/index.html";
+}
+
+static const tCGI cgi_handlers[] = {
     { "/", cgi_handler_index },
-    { "/index.shtml", cgi_handler_index },
-    { "/rgb.cgi", cgi_handler_rgb },
-    { "/oled.cgi", cgi_handler_oled },
-    { "/matrix.cgi", cgi_handler_matrix },
-    { "/buzzer.cgi", cgi_handler_buzzer },
+    { "/index.html", cgi_handler_index },
+#define CGI_ROUTE_ENTRY(id, uri) { uri, cgi_handler_route },
+    HTTP_ROUTE_LIST(CGI_ROUTE_ENTRY)
+#undef CGI_ROUTE_ENTRY
 };
 
 // Note that the buffer size is limited by LWIP_HTTPD_MAX_TAG_INSERT_LEN, so use LWIP_HTTPD_SSI_MULTIPART to return larger amounts of data
@@ -573,9 +1100,10 @@ u16_t ssi_example_ssi_handler(int iIndex, char *pcInsert, int iInsertLen
 #endif
 ) {
     size_t printed;
+    input_snapshot_t in;
     
-    // Read current input states before processing SSI
-    read_inputs();
+    // O(1) copy of the latest background sample, no ADC/GPIO access here
+    input_sampler_read(&in);
     
     switch (iIndex) {
         case 0: { // "status"
@@ -610,23 +1138,23 @@ u16_t ssi_example_ssi_handler(int iIndex, char *pcInsert, int iInsertLen
         }
 #endif
         case 6: { // "btna" - Button A state
-            printed = snprintf(pcInsert, iInsertLen, "%d", btn_a_pressed ? 0 : 1);
+            printed = snprintf(pcInsert, iInsertLen, "%d", in.btn_a_pressed ? 0 : 1);
             break;
         }
         case 7: { // "btnb" - Button B state
-            printed = snprintf(pcInsert, iInsertLen, "%d", btn_b_pressed ? 0 : 1);
+            printed = snprintf(pcInsert, iInsertLen, "%d", in.btn_b_pressed ? 0 : 1);
             break;
         }
         case 8: { // "joyx" - Joystick X axis
-            printed = snprintf(pcInsert, iInsertLen, "%u", joystick_x);
+            printed = snprintf(pcInsert, iInsertLen, "%u", in.joystick_x);
             break;
         }
         case 9: { // "joyy" - Joystick Y axis
-            printed = snprintf(pcInsert, iInsertLen, "%u", joystick_y);
+            printed = snprintf(pcInsert, iInsertLen, "%u", in.joystick_y);
             break;
         }
         case 10: { // "joybtn" - Joystick button
-            printed = snprintf(pcInsert, iInsertLen, "%d", joy_btn_pressed ? 0 : 1);
+            printed = snprintf(pcInsert, iInsertLen, "%d", in.joy_btn_pressed ? 0 : 1);
             break;
         }
         case 11: { // "rgbr" - RGB Red value
@@ -642,7 +1170,15 @@ u16_t ssi_example_ssi_handler(int iIndex, char *pcInsert, int iInsertLen
             break;
         }
         case 14: { // "temp" - Chip temperature
-            printed = snprintf(pcInsert, iInsertLen, "%.1f", chip_temperature);
+            printed = snprintf(pcInsert, iInsertLen, "%.1f", in.temperature_c);
+            break;
+        }
+        case 15: { // "bzq" - Buzzer queue depth
+            printed = snprintf(pcInsert, iInsertLen, "%u", buzzer_queue_depth(BUZZER_CH_BOTH));
+            break;
+        }
+        case 16: { // "bzdrop" - Buzzer notes dropped (queue full)
+            printed = snprintf(pcInsert, iInsertLen, "%lu", (unsigned long)buzzer_dropped_count());
             break;
         }
         default: { // unknown tag
@@ -670,145 +1206,371 @@ static const char *ssi_tags[] = {
     "rgbg",     // 12
     "rgbb",     // 13
     "temp",     // 14
+    "bzq",      // 15
+    "bzdrop",   // 16
 };
 
-#if LWIP_HTTPD_SUPPORT_POST
-#define LED_STATE_BUFSIZE 4
-static void *current_connection;
+#if LWIP_HTTPD_CUSTOM_FILES
+// Dynamic files served through fs_open_custom(): the response (headers
+// included) is rendered once on open into a slot of a static pool, so the
+// hot polling path does no SSI tag scanning and no heap allocation.
+#define API_STATE_URI       "/api/state"
+#define API_STATE_BODY_MAX  120
+// Longest header api_open_json() writes: a 200 with a three-digit
+// Content-Length, the largest ETag and the longer Cache-Control and
+// Connection values
+#define API_STATE_HEADER_WORST \
+    "HTTP/1.1 200 OK\r\n" \
+    "Content-Type: application/json\r\n" \
+    "Content-Length: 999\r\n" \
+    "ETag: \"s4294967295\"\r\n" \
+    "Cache-Control: no-store\r\n" \
+    "Connection: keep-alive\r\n" \
+    "\r\n"
+#define API_STATE_RESP_MAX  ((int)sizeof(API_STATE_HEADER_WORST) - 1 + API_STATE_BODY_MAX)
+_Static_assert(API_STATE_BODY_MAX <= 1000, "Content-Length in API_STATE_HEADER_WORST has three digits");
+// One slot per possible TCP connection: httpd may still be sending one
+// client's response while another client opens the file
+#define API_STATE_SLOTS     MEMP_NUM_TCP_PCB
 
-err_t httpd_post_begin(void *connection, const char *uri, const char *http_request,
-        u16_t http_request_len, int content_len, char *response_uri,
-        u16_t response_uri_len, u8_t *post_auto_wnd) {
-    if (current_connection != connection) {
-        if (memcmp(uri, "/led.cgi", 8) == 0 ||
-            memcmp(uri, "/rgb.cgi", 8) == 0 ||
-            memcmp(uri, "/oled.cgi", 9) == 0 ||
-            memcmp(uri, "/matrix.cgi", 11) == 0 ||
-            memcmp(uri, "/buzzer.cgi", 11) == 0) {
-            current_connection = connection;
-            snprintf(response_uri, response_uri_len, "/index.shtml");
-            *post_auto_wnd = 1;
-            return ERR_OK;
-        }
-    }
-    return ERR_VAL;
-}
-
-// Return a value for a parameter
-char *httpd_param_value(struct pbuf *p, const char *param_name, char *value_buf, size_t value_buf_len) {
-    size_t param_len = strlen(param_name);
-    u16_t param_pos = pbuf_memfind(p, param_name, param_len, 0);
-    if (param_pos != 0xFFFF) {
-        u16_t param_value_pos = param_pos + param_len;
-        u16_t param_value_len = 0;
-        u16_t tmp = pbuf_memfind(p, "&", 1, param_value_pos);
-        if (tmp != 0xFFFF) {
-            param_value_len = tmp - param_value_pos;
-        } else {
-            param_value_len = p->tot_len - param_value_pos;
+static char api_state_resp[API_STATE_SLOTS][API_STATE_RESP_MAX];
+static bool api_state_used[API_STATE_SLOTS];
+
+// /api/state is versioned (ETag "s<state_version>"); the inputs are
+// republished at least this often so the uptime keeps moving
+#define API_STATE_UPTIME_REFRESH_S  (HTTP_SSE_HEARTBEAT_MS / 1000)
+
+// Responses for API-style POSTs, picked in httpd_post_begin() from the
+// request headers instead of re-rendering the whole index page
+#define API_ACK_URI         "/api/ack"      // {"ok":true,"v":<state_version>}
+#define API_NO_CONTENT_URI  "/api/204"
+
+static const char api_no_content[] =
+    "HTTP/1.1 204 No Content\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+// Last request allowed on a persistent connection
+static const char api_no_content_close[] =
+    "HTTP/1.1 204 No Content\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// Everything /api/state reports
+typedef struct {
+    input_snapshot_t in;
+    uint32_t uptime_s;
+    uint16_t bzq;
+    uint32_t bzdrop;
+} device_state_t;
+
+// Snapshot served by /api/state for the current state_version
+static device_state_t state_published;
+
+static void device_state_read(device_state_t *s) {
+    input_sampler_read(&s->in);
+    s->uptime_s = (uint32_t)(absolute_time_diff_us(wifi_connected_time, get_absolute_time()) / 1000000);
+    s->bzq = buzzer_queue_depth(BUZZER_CH_BOTH);
+    s->bzdrop = buzzer_dropped_count();
+}
+
+// Compact JSON with the same keys as state.shtml; buttons are 1 when pressed
+static int device_state_render(char *buf, size_t len, const device_state_t *s) {
+    return snprintf(buf, len,
+        "{\"btna\":%d,\"btnb\":%d,\"joyx\":%u,\"joyy\":%u,\"joybtn\":%d,"
+        "\"uptime\":%lu,\"temp\":%.1f,\"bzq\":%u,\"bzdrop\":%lu}",
+        s->in.btn_a_pressed, s->in.btn_b_pressed, s->in.joystick_x, s->in.joystick_y, s->in.joy_btn_pressed,
+        (unsigned long)s->uptime_s, s->in.temperature_c, s->bzq, (unsigned long)s->bzdrop);
+}
+
+// Live values, for the "state" event of the stream
+static int api_state_render_body(char *buf, size_t len) {
+    device_state_t s;
+    device_state_read(&s);
+    return device_state_render(buf, len, &s);
+}
+
+static int api_state_published_render_body(char *buf, size_t len) {
+    return device_state_render(buf, len, &state_published);
+}
+
+// Publish the live inputs as a new state version when they moved past the
+// same thresholds the event stream uses; ADC noise alone keeps the version.
+// Evaluated when /api/state is opened, so it costs nothing without pollers.
+static void device_state_refresh(void) {
+    device_state_t now;
+    device_state_read(&now);
+    const device_state_t *old = &state_published;
+
+    float dt = now.in.temperature_c - old->in.temperature_c;
+    bool changed =
+        now.in.btn_a_pressed != old->in.btn_a_pressed ||
+        now.in.btn_b_pressed != old->in.btn_b_pressed ||
+        now.in.joy_btn_pressed != old->in.joy_btn_pressed ||
+        abs((int)now.in.joystick_x - (int)old->in.joystick_x) > HTTP_SSE_JOY_DEADBAND ||
+        abs((int)now.in.joystick_y - (int)old->in.joystick_y) > HTTP_SSE_JOY_DEADBAND ||
+        dt >= HTTP_SSE_TEMP_DELTA_C || -dt >= HTTP_SSE_TEMP_DELTA_C ||
+        now.bzq != old->bzq || now.bzdrop != old->bzdrop ||
+        // uptime refreshes as often as the stream's heartbeat
+        now.uptime_s - old->uptime_s >= API_STATE_UPTIME_REFRESH_S;
+    if (changed) {
+        state_published = now;
+        state_version++;
+    }
+}
+
+static int api_ack_render_body(char *buf, size_t len) {
+    return snprintf(buf, len, "{\"ok\":true,\"v\":%lu}", (unsigned long)state_version);
+}
+
+// Heartbeat of the event stream: the slow-changing values not covered by events
+static int api_heartbeat_render_body(char *buf, size_t len) {
+    uint32_t uptime_s = (uint32_t)(absolute_time_diff_us(wifi_connected_time, get_absolute_time()) / 1000000);
+    return snprintf(buf, len, "{\"uptime\":%lu,\"bzq\":%u,\"bzdrop\":%lu}",
+        (unsigned long)uptime_s, buzzer_queue_depth(BUZZER_CH_BOTH), (unsigned long)buzzer_dropped_count());
+}
+
+static void init_event_stream(void) {
+    const http_sse_config_t config = {
+        .poll_ms = HTTP_SSE_POLL_MS,
+        .heartbeat_ms = HTTP_SSE_HEARTBEAT_MS,
+        .joy_deadband = HTTP_SSE_JOY_DEADBAND,
+        .temp_delta_c = HTTP_SSE_TEMP_DELTA_C,
+        .render_state = api_state_render_body,
+        .render_heartbeat = api_heartbeat_render_body,
+    };
+    http_sse_init(&config);
+}
+
+// Render a JSON response (headers included) into a free slot of the pool.
+// With an ETag the response may be cached and revalidated, and a client
+// that already holds that version gets a bodiless 304 instead.
+static int api_open_json(struct fs_file *file, const char *name, int (*render_body)(char *buf, size_t len),
+                         const char *etag) {
+    int slot;
+    for (slot = 0; slot < API_STATE_SLOTS; slot++) {
+        if (!api_state_used[slot]) {
+            break;
         }
-        if (param_value_len > 0 && param_value_len < value_buf_len) {
-            char *result = (char *)pbuf_get_contiguous(p, value_buf, value_buf_len, param_value_len, param_value_pos);
-            if (result) {
-                result[param_value_len] = 0;
-                return result;
-            }
+    }
+    if (slot == API_STATE_SLOTS) {
+        LOG_WARN("[API] Sem buffer livre para %s", name);
+        return 0;
+    }
+
+    char *resp = api_state_resp[slot];
+    int len;
+    if (etag != NULL && http_cache_etag_match(http_headers_get(HTTP_HDR_IF_NONE_MATCH), etag)) {
+        len = snprintf(resp, API_STATE_RESP_MAX,
+            "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: %s\r\n"
+            "Cache-Control: no-cache\r\n"
+            "%s"
+            "\r\n", etag, http_keepalive_header());
+    } else {
+        char body[API_STATE_BODY_MAX];
+        int body_len = render_body(body, sizeof(body));
+        if (body_len < 0 || body_len >= (int)sizeof(body)) {
+            return 0;
+        }
+        len = snprintf(resp, API_STATE_RESP_MAX,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: %d\r\n"
+            "%s%s%s"
+            "Cache-Control: %s\r\n"
+            "%s"
+            "\r\n"
+            "%s", body_len,
+            etag ? "ETag: " : "", etag ? etag : "", etag ? "\r\n" : "",
+            etag ? "no-cache" : "no-store", http_keepalive_header(), body);
+    }
+    if (len < 0 || len >= API_STATE_RESP_MAX) {
+        return 0;
+    }
+
+    api_state_used[slot] = true;
+    memset(file, 0, sizeof(struct fs_file));
+    file->data = resp;
+    file->len = len;
+    file->index = len;
+    file->flags = http_keepalive_flags(); // complete response: may stay open
+    return 1;
+}
+
+static int api_open_state(struct fs_file *file, const char *name) {
+    char etag[16];
+    device_state_refresh();
+    snprintf(etag, sizeof(etag), "\"s%lu\"", (unsigned long)state_version);
+    return api_open_json(file, name, api_state_published_render_body, etag);
+}
+
+int fs_open_custom(struct fs_file *file, const char *name) {
+    if (http_sse_open(file, name)) {
+        return 1;
+    }
+    if (http_metrics_open(file, name)) {
+        return 1;
+    }
+    if (strcmp(name, API_STATE_URI) == 0) {
+        return api_open_state(file, name);
+    }
+    if (strcmp(name, API_ACK_URI) == 0) {
+        return api_open_json(file, name, api_ack_render_body, NULL);
+    }
+    if (strcmp(name, API_NO_CONTENT_URI) == 0) {
+        memset(file, 0, sizeof(struct fs_file));
+        file->data = http_keepalive_allowed() ? api_no_content : api_no_content_close;
+        file->len = strlen(file->data);
+        file->index = file->len;
+        file->flags = http_keepalive_flags();
+        return 1;
+    }
+    if (http_encoding_open(file, name)) {
+        return 1; // embedded file in another Content-Encoding (or its 304)
+    }
+    if (http_cache_open(file, name)) {
+        return 1; // 304 for an embedded file the client already has
+    }
+    if (http_keepalive_open_last(file, name)) {
+        return 1; // embedded file, then close the connection
+    }
+    return 0; // fall back to the fsdata image
+}
+
+void fs_close_custom(struct fs_file *file) {
+    if (http_sse_close(file)) {
+        return;
+    }
+    if (http_metrics_close(file)) {
+        return;
+    }
+    for (int slot = 0; slot < API_STATE_SLOTS; slot++) {
+        if (file->data == api_state_resp[slot]) {
+            api_state_used[slot] = false;
+            return;
+        }
+    }
+}
+
+#if LWIP_HTTPD_FS_ASYNC_READ
+// Only the event stream, /metrics and the last response of a persistent
+// connection are read dynamically; every other custom file is fully
+// rendered on open and never reaches these hooks. /metrics and the last
+// response come from memory and never wait.
+u8_t fs_canread_custom(struct fs_file *file) {
+    if (http_metrics_owns(file) || http_keepalive_owns(file)) {
+        return 1;
+    }
+    return http_sse_canread(file);
+}
+
+u8_t fs_wait_read_custom(struct fs_file *file, fs_wait_cb callback_fn, void *callback_arg) {
+    if (http_metrics_owns(file) || http_keepalive_owns(file)) {
+        return 1;
+    }
+    return http_sse_wait_read(file, callback_fn, callback_arg);
+}
+
+int fs_read_async_custom(struct fs_file *file, char *buffer, int count, fs_wait_cb callback_fn, void *callback_arg) {
+    if (http_metrics_owns(file)) {
+        return http_metrics_read(file, buffer, count);
+    }
+    if (http_keepalive_owns(file)) {
+        return http_keepalive_read(file, buffer, count);
+    }
+    return http_sse_read(file, buffer, count, callback_fn, callback_arg);
+}
+#endif
+#endif // LWIP_HTTPD_CUSTOM_FILES
+
+#if LWIP_HTTPD_SUPPORT_POST
+// POST bodies are tokenized in a single pass as the pbufs arrive; the route
+// is resolved once in httpd_post_begin and each decoded value goes straight
+// to its handler.
+static post_ctx_t post_ctxs[POST_CTX_COUNT];
+
+static post_ctx_t *post_ctx_find(void *connection) {
+    for (int i = 0; i < POST_CTX_COUNT; i++) {
+        if (post_ctxs[i].connection == connection) {
+            return &post_ctxs[i];
         }
     }
     return NULL;
 }
 
-#define POST_BUF_SIZE 512
-static char post_buffer[POST_BUF_SIZE];
+static post_ctx_t *post_ctx_alloc(void *connection) {
+    // Same connection (or a new one whose state got the same address): httpd
+    // never reports a POST dropped mid-body, so the old request may still
+    // hold resources
+    post_ctx_t *ctx = post_ctx_find(connection);
+    if (ctx != NULL) {
+        route_ctx_abort(ctx);
+    }
+    for (int i = 0; ctx == NULL && i < POST_CTX_COUNT; i++) {
+        if (post_ctxs[i].connection == NULL) {
+            ctx = &post_ctxs[i];
+        }
+    }
+    for (int i = 0; ctx == NULL && i < POST_CTX_COUNT; i++) {
+        if (absolute_time_diff_us(post_ctxs[i].started, get_absolute_time()) > POST_CTX_TIMEOUT_MS * 1000) {
+            LOG_WARN("[POST] Contexto abandonado reutilizado");
+            ctx = &post_ctxs[i];
+            route_ctx_abort(ctx);
+        }
+    }
+    return ctx;
+}
+
+// Case-sensitive search over the raw request; httpd has already written a
+// '\0' after the URI, so the C string functions would stop there
+// fetch() callers ask for a JSON ack ("Accept: application/json") or for no
+// body at all ("Prefer: return=minimal"); classic form submissions get the
+// page. Only the captured header values are looked at, never the body
+static const char *post_response_for(void) {
+    if (http_headers_list_q(http_headers_get(HTTP_HDR_ACCEPT), "application/json") > 0) {
+        return API_ACK_URI;
+    }
+    if (http_headers_list_q(http_headers_get(HTTP_HDR_PREFER), "return=minimal") >= 0) {
+        return API_NO_CONTENT_URI;
+    }
+    return "/index.html";
+}
+
+err_t httpd_post_begin(void *connection, const char *uri, const char *http_request,
+        u16_t http_request_len, int content_len, char *response_uri,
+        u16_t response_uri_len, u8_t *post_auto_wnd) {
+    LWIP_UNUSED_ARG(http_request);
+    LWIP_UNUSED_ARG(http_request_len);
+    int route = http_route_find(uri);
+    if (route < 0) {
+        return ERR_VAL;
+    }
+    post_ctx_t *ctx = post_ctx_alloc(connection);
+    if (ctx == NULL) {
+        LOG_WARN("[POST] Sem contexto livre para %s", uri);
+        return ERR_MEM;
+    }
+    ctx->connection = connection;
+    ctx->started = get_absolute_time();
+    ctx->body_left = content_len;
+    snprintf(ctx->response_uri, sizeof(ctx->response_uri), "%s", post_response_for());
+    route_ctx_begin(ctx, route);
+    snprintf(response_uri, response_uri_len, "%s", ctx->response_uri);
+    *post_auto_wnd = 1;
+    return ERR_OK;
+}
 
 err_t httpd_post_receive_data(void *connection, struct pbuf *p) {
-    err_t ret = ERR_VAL;
     LWIP_ASSERT("NULL pbuf", p != NULL);
+    err_t ret = ERR_VAL;
     
-    if (current_connection == connection) {
-        // Copy POST data to buffer
-        u16_t len = pbuf_copy_partial(p, post_buffer, POST_BUF_SIZE - 1, 0);
-        post_buffer[len] = '\0';
-        
-        // Handle LED state (legacy)
-        char buf[8];
-        char *val = httpd_param_value(p, "led_state=", buf, sizeof(buf));
-        if (val) {
-            led_on = (strcmp(val, "ON") == 0) ? true : false;
-            cyw43_gpio_set(&cyw43_state, 0, led_on);
-            ret = ERR_OK;
-        }
-        
-        // Handle RGB LED
-        char r_buf[8], g_buf[8], b_buf[8];
-        char *r_val = httpd_param_value(p, "r=", r_buf, sizeof(r_buf));
-        char *g_val = httpd_param_value(p, "g=", g_buf, sizeof(g_buf));
-        char *b_val = httpd_param_value(p, "b=", b_buf, sizeof(b_buf));
-        if (r_val && g_val && b_val) {
-            set_rgb_led((uint8_t)atoi(r_val), (uint8_t)atoi(g_val), (uint8_t)atoi(b_val));
-            ret = ERR_OK;
-        }
-        
-        // Handle OLED text
-        // Buffer larger to handle URL-encoded UTF-8 chars before decoding
-        char text_buf[OLED_MAX_CHARS * 4 + 1];
-        char *text_val = httpd_param_value(p, "text=", text_buf, sizeof(text_buf));
-        if (text_val) {
-            // Full URL decode (%XX and +)
-            url_decode(text_val);
-            // Remove accents (OLED doesn't support them)
-            remove_accents(text_val);
-            // Truncate to max OLED chars
-            text_val[OLED_MAX_CHARS] = '\0';
-            oled_push_line(text_val);
-            ret = ERR_OK;
-        }
-        
-        // Handle LED Matrix data
-        char data_buf[256];
-        char *data_val = httpd_param_value(p, "data=", data_buf, sizeof(data_buf));
-        if (data_val) {
-            // URL decode first (commas are encoded as %2C)
-            url_decode(data_val);
-            // Parse comma-separated hex colors
-            int led_index = 0;
-            char *token = strtok(data_val, ",");
-            while (token != NULL && led_index < NEOPIXEL_NUM_LEDS) {
-                uint32_t color = (uint32_t)strtoul(token, NULL, 16);
-
-                uint8_t r = (color >> 16) & 0xFF;
-                uint8_t g = (color >> 8) & 0xFF;
-                uint8_t b = color & 0xFF;
-                npSetLED(led_index, r, g, b);
-
-                led_index++;
-                token = strtok(NULL, ",");
-            }
-            LOG_DEBUG("LED Matrix: %d LEDs updated", led_index);
-            npWrite();
-            ret = ERR_OK;
-        }
-        
-        // Handle Buzzer
-        char freq_buf[8], dur_buf[8], ch_buf[8];
-        char *freq_val = httpd_param_value(p, "freq=", freq_buf, sizeof(freq_buf));
-        char *dur_val = httpd_param_value(p, "dur=", dur_buf, sizeof(dur_buf));
-        char *ch_val = httpd_param_value(p, "ch=", ch_buf, sizeof(ch_buf));
-        if (freq_val || dur_val) {
-            uint16_t freq = freq_val ? (uint16_t)atoi(freq_val) : 1000;
-            uint16_t dur = dur_val ? (uint16_t)atoi(dur_val) : 100;
-            uint8_t channel = 0;
-            if (ch_val) {
-                if (strcmp(ch_val, "left") == 0) channel = 1;
-                else if (strcmp(ch_val, "right") == 0) channel = 2;
-            }
-            if (freq > 10000) freq = 10000;
-            if (freq < 100) freq = 100;
-            if (dur > 2000) dur = 2000;
-            if (dur < 10) dur = 10;
-            buzzer_play(freq, dur, channel);
-            ret = ERR_OK;
-        }
+    post_ctx_t *ctx = post_ctx_find(connection);
+    if (ctx != NULL) {
+        ctx->body_left -= p->tot_len;
+        http_route_feed_pbuf(&ctx->req, p);
+        ret = ERR_OK;
     }
     
     pbuf_free(p);
@@ -816,8 +1578,20 @@ err_t httpd_post_receive_data(void *connection, struct pbuf *p) {
 }
 
 void httpd_post_finished(void *connection, char *response_uri, u16_t response_uri_len) {
-    snprintf(response_uri, response_uri_len, "/index.shtml");
-    current_connection = NULL;
+    post_ctx_t *ctx = post_ctx_find(connection);
+    if (ctx == NULL) {
+        snprintf(response_uri, response_uri_len, "/index.html");
+        return;
+    }
+    // httpd also calls this when the connection closes mid-body; only a
+    // complete body is applied
+    if (ctx->body_left <= 0) {
+        route_ctx_finish(ctx);
+    } else {
+        route_ctx_abort(ctx);
+    }
+    snprintf(response_uri, response_uri_len, "%s", ctx->response_uri);
+    ctx->connection = NULL;
 }
 #endif
 
@@ -902,8 +1676,20 @@ int main() {
     httpd_init();
     http_set_cgi_handlers(cgi_handlers, LWIP_ARRAYSIZE(cgi_handlers));
     http_set_ssi_handler(ssi_example_ssi_handler, ssi_tags, LWIP_ARRAYSIZE(ssi_tags));
+    init_event_stream();
+    if (!ws_server_init(WS_SERVER_PORT, ws_command_handler)) {
+        LOG_WARN("Falha ao iniciar servidor WebSocket!");
+    }
     cyw43_arch_lwip_end();
     LOG_INFO("Servidor HTTP iniciado!");
+#if HTTPD_PRECALCULATED_CHECKSUM
+    // Software checksum vs. precalculated table over the embedded files
+    http_chksum_benchmark();
+#endif
+#if HTTPD_ZERO_COPY
+    // SRAM and CPU per download, copied vs. referenced in flash
+    http_zerocopy_benchmark();
+#endif
 
     LOG_INFO("Entrando no loop principal...");
     uint32_t loop_count = 0;
@@ -912,11 +1698,12 @@ int main() {
         cyw43_arch_poll();
         cyw43_arch_wait_for_work_until(led_time);
 #else
-        busy_wait_ms(1000);
+        busy_wait_ms(MAIN_LOOP_PERIOD_MS);
+        oled_flush_pending();
         loop_count++;
         // Log periódico a cada 30 segundos para mostrar que está ativo
-        if (loop_count % 30 == 0) {
-            LOG_TRACE("Sistema ativo - uptime: %lu segundos", loop_count);
+        if (loop_count % (30000 / MAIN_LOOP_PERIOD_MS) == 0) {
+            LOG_TRACE("Sistema ativo - uptime: %lu segundos", loop_count / (1000 / MAIN_LOOP_PERIOD_MS));
         }
 #endif
     }
@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""
+@file    gen_http_routes.py
+@brief   Gera as tabelas de rotas e parâmetros dos CGIs com hash perfeito
+
+@details Lê http_routes.def e escreve http_routes_gen.h (ids das rotas, das
+         chaves e constantes dos enums) e http_routes_gen.c (descritores e
+         tabelas de hash). Para cada conjunto de strings (URIs, chaves e
+         nomes de cada enum) procura uma semente do FNV-1a que leve todas a slots distintos de
+         uma tabela potência de 2; em tempo de execução a busca é um hash
+         e uma única comparação, independente do número de rotas.
+
+         Uso: gen_http_routes.py <http_routes.def> <diretório de saída>
+
+@project BitDogLab_HTTPDd_workspace
+@url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+
+@license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+"""
+
+import os
+import re
+import sys
+
+FNV_PRIME = 16777619
+MAX_SEED_TRIES = 100000
+EMPTY_SLOT = 0xFF
+
+TYPES = {
+    # tipo: (constante C, máximo padrão)
+    "u8": ("HTTP_PARAM_U8", 0xFF),
+    "u16": ("HTTP_PARAM_U16", 0xFFFF),
+    "u32": ("HTTP_PARAM_U32", 0xFFFFFFFF),
+    "enum": ("HTTP_PARAM_ENUM", 0),
+    "hexlist": ("HTTP_PARAM_HEXLIST", 0),
+    "text": ("HTTP_PARAM_TEXT", None),
+    "flag": ("HTTP_PARAM_FLAG", 1),
+    "stream": ("HTTP_PARAM_STREAM", 0),
+}
+
+
+def fnv1a(seed, data):
+    """Mesmo hash de http_route_hash() em http_route.c."""
+    h = seed
+    for b in data.encode("ascii"):
+        h ^= b
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h ^ (h >> 16)
+
+
+def perfect_hash(names):
+    """Retorna (semente, slots) sem colisões para a lista de strings."""
+    size = 1
+    while size < len(names):
+        size *= 2
+    while True:
+        for seed in range(1, MAX_SEED_TRIES):
+            slots = [EMPTY_SLOT] * size
+            for index, name in enumerate(names):
+                slot = fnv1a(seed, name) & (size - 1)
+                if slots[slot] != EMPTY_SLOT:
+                    break
+                slots[slot] = index
+            else:
+                return seed, slots
+        size *= 2
+
+
+def fail(path, lineno, msg):
+    sys.exit("%s:%d: %s" % (path, lineno, msg))
+
+
+def enum_from_header(path, lineno, ref):
+    """Nomes de um enum "@<cabeçalho>:<MACRO>": o segundo argumento de cada
+    X(...) da X-macro, na ordem, para que o índice seja o valor do enum C."""
+    header, _, macro = ref[1:].partition(":")
+    header = os.path.join(os.path.dirname(os.path.abspath(path)), header)
+    try:
+        with open(header, encoding="utf-8") as f:
+            text = f.read()
+    except OSError as e:
+        fail(path, lineno, "não foi possível ler %s: %s" % (header, e.strerror))
+    m = re.search(r"#define\s+%s\(X\)((?:.*\\\n)*.*)" % re.escape(macro), text)
+    if not m:
+        fail(path, lineno, "X-macro %s não encontrada em %s" % (macro, header))
+    names = re.findall(r"X\(\s*\w+\s*,\s*\"([^\"]+)\"", m.group(1))
+    if not names:
+        fail(path, lineno, "X-macro %s sem nomes" % macro)
+    return names
+
+
+def parse(path):
+    routes = []
+    with open(path, encoding="utf-8") as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].rstrip()
+            if not line.strip():
+                continue
+            fields = line.split()
+            if not line[0].isspace():
+                if fields[0] != "route" or len(fields) != 3:
+                    fail(path, lineno, "esperado 'route <ID> <uri>'")
+                route_id, uri = fields[1], fields[2]
+                if not re.fullmatch(r"[A-Z][A-Z0-9_]*", route_id) or not uri.startswith("/"):
+                    fail(path, lineno, "rota inválida")
+                routes.append({"id": route_id, "uri": uri, "params": []})
+                continue
+
+            if not routes:
+                fail(path, lineno, "parâmetro fora de uma rota")
+            key, ptype, args = fields[0], fields[1], fields[2:]
+            if ptype not in TYPES:
+                fail(path, lineno, "tipo desconhecido '%s'" % ptype)
+            if not re.fullmatch(r"[a-z][a-z0-9_]*", key):
+                fail(path, lineno, "chave inválida '%s'" % key)
+            if any(p["key"] == key for p in routes[-1]["params"]):
+                fail(path, lineno, "chave repetida '%s'" % key)
+
+            maximum = TYPES[ptype][1]
+            names = []
+            if ptype == "enum":
+                if len(args) == 1 and args[0].startswith("@"):
+                    args = enum_from_header(path, lineno, args[0])
+                if not args or len(args) > 254:
+                    fail(path, lineno, "enum sem nomes")
+                if len(set(args)) != len(args):
+                    fail(path, lineno, "nome repetido no enum")
+                names = args
+            elif ptype == "text":
+                if len(args) != 1:
+                    fail(path, lineno, "text precisa do tamanho máximo")
+                maximum = int(args[0], 0)
+            elif ptype in ("u8", "u16", "u32") and args:
+                maximum = min(int(args[0], 0), maximum)
+            elif args:
+                fail(path, lineno, "argumentos inesperados")
+            routes[-1]["params"].append({"key": key, "type": ptype, "max": maximum, "names": names})
+
+    if not routes:
+        sys.exit("%s: nenhuma rota" % path)
+    for r in routes:
+        # Páginas sem parâmetros continuam em cgi_handlers[] de pico_httpd.c
+        if not r["params"]:
+            sys.exit("%s: rota %s sem parâmetros" % (path, r["id"]))
+        if len(r["uri"]) > 255:
+            sys.exit("%s: URI longa demais em %s" % (path, r["id"]))
+    if len(routes) >= EMPTY_SLOT:
+        sys.exit("%s: rotas demais" % path)
+    return routes
+
+
+def write_header(out, routes, keys, uri_seed, uri_slots, key_seed, key_slots):
+    w = out.write
+    w("// Gerado por tools/gen_http_routes.py a partir de http_routes.def. Não edite.\n\n")
+    w("#ifndef HTTP_ROUTES_GEN_H\n#define HTTP_ROUTES_GEN_H\n\n")
+
+    w("// X(ID, uri) para cada rota, na ordem do arquivo\n")
+    w("#define HTTP_ROUTE_LIST(X) \\\n")
+    for r in routes:
+        w("    X(HTTP_ROUTE_%s, \"%s\") \\\n" % (r["id"], r["uri"]))
+    w("\n")
+
+    w("typedef enum {\n")
+    for r in routes:
+        w("    HTTP_ROUTE_%s,\n" % r["id"])
+    w("    HTTP_ROUTE_COUNT\n} http_route_id_t;\n\n")
+
+    w("typedef enum {\n")
+    for k in keys:
+        w("    HTTP_KEY_%s,\n" % k.upper())
+    w("    HTTP_KEY_COUNT\n} http_key_id_t;\n\n")
+
+    enums = {}
+    for r in routes:
+        for p in r["params"]:
+            if p["type"] == "enum":
+                prev = enums.setdefault(p["key"], p["names"])
+                if prev != p["names"]:
+                    sys.exit("enum '%s' com nomes diferentes entre rotas" % p["key"])
+    for key, names in enums.items():
+        for i, name in enumerate(names):
+            w("#define HTTP_%s_%s %d\n" % (key.upper(), re.sub(r"\W", "_", name).upper(), i))
+        w("\n")
+
+    w("#define HTTP_ROUTE_URI_SEED     %uu\n" % uri_seed)
+    w("#define HTTP_ROUTE_URI_SLOTS    %d\n" % len(uri_slots))
+    w("#define HTTP_ROUTE_KEY_SEED     %uu\n" % key_seed)
+    w("#define HTTP_ROUTE_KEY_SLOTS    %d\n\n" % len(key_slots))
+    w("#endif // HTTP_ROUTES_GEN_H\n")
+
+
+def c_list(values, per_line=16):
+    items = ["%d" % v for v in values]
+    return ",\n    ".join(", ".join(items[i:i + per_line]) for i in range(0, len(items), per_line))
+
+
+def write_source(out, routes, keys, uri_slots, key_slots):
+    w = out.write
+    w("// Gerado por tools/gen_http_routes.py a partir de http_routes.def. Não edite.\n\n")
+    w("#include \"http_route.h\"\n\n")
+
+    w("const uint8_t http_route_uri_slots[HTTP_ROUTE_URI_SLOTS] = {\n    %s\n};\n\n" % c_list(uri_slots))
+    w("const uint8_t http_route_key_slots[HTTP_ROUTE_KEY_SLOTS] = {\n    %s\n};\n\n" % c_list(key_slots))
+
+    w("const char *const http_route_key_names[HTTP_KEY_COUNT] = {\n")
+    for k in keys:
+        w("    \"%s\",\n" % k)
+    w("};\n\n")
+
+    for r in routes:
+        name = r["id"].lower()
+        for p in r["params"]:
+            if p["type"] == "enum":
+                prefix = "%s_%s" % (name, p["key"])
+                w("static const char *const %s_names[] = {\n    %s\n};\n"
+                  % (prefix, ",\n    ".join("\"%s\"" % n for n in p["names"])))
+                w("static const uint8_t %s_slots[] = {\n    %s\n};\n" % (prefix, c_list(p["slots"])))
+        w("static const http_param_desc_t %s_params[] = {\n" % name)
+        for p in r["params"]:
+            if p["type"] == "enum":
+                prefix = "%s_%s" % (name, p["key"])
+                enum = "%s_names, %d, %uu, %s_slots, %d" % (prefix, len(p["names"]), p["seed"], prefix,
+                                                         len(p["slots"]))
+            else:
+                enum = "NULL, 0, 0, NULL, 0"
+            w("    { HTTP_KEY_%s, %s, %uu, %s },\n"
+              % (p["key"].upper(), TYPES[p["type"]][0], p["max"], enum))
+        w("};\n")
+        index = [EMPTY_SLOT] * len(keys)
+        for i, p in enumerate(r["params"]):
+            index[keys.index(p["key"])] = i
+        w("static const uint8_t %s_param_map[HTTP_KEY_COUNT] = {\n    %s\n};\n\n" % (name, c_list(index)))
+
+    w("const http_route_desc_t http_routes[HTTP_ROUTE_COUNT] = {\n")
+    for r in routes:
+        name = r["id"].lower()
+        w("    [HTTP_ROUTE_%s] = { \"%s\", %d, %s_params, %s_param_map },\n"
+          % (r["id"], r["uri"], len(r["uri"]), name, name))
+    w("};\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("uso: %s <http_routes.def> <diretório de saída>" % sys.argv[0])
+    routes = parse(sys.argv[1])
+
+    keys = []
+    for r in routes:
+        for p in r["params"]:
+            if p["key"] not in keys:
+                keys.append(p["key"])
+    if len(keys) >= EMPTY_SLOT:
+        sys.exit("chaves demais")
+
+    uri_seed, uri_slots = perfect_hash([r["uri"] for r in routes])
+    key_seed, key_slots = perfect_hash(keys)
+    for r in routes:
+        for p in r["params"]:
+            if p["type"] == "enum":
+                p["seed"], p["slots"] = perfect_hash(p["names"])
+
+    os.makedirs(sys.argv[2], exist_ok=True)
+    with open(os.path.join(sys.argv[2], "http_routes_gen.h"), "w", encoding="utf-8") as out:
+        write_header(out, routes, keys, uri_seed, uri_slots, key_seed, key_slots)
+    with open(os.path.join(sys.argv[2], "http_routes_gen.c"), "w", encoding="utf-8") as out:
+        write_source(out, routes, keys, uri_slots, key_slots)
+
+
+if __name__ == "__main__":
+    main()
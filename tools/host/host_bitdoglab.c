@@ -0,0 +1,128 @@
+/**
+ * @file    host_bitdoglab.c
+ * @brief   Matriz de LEDs e OLED simulados para o harness do host
+ * @details Substituem neopixel_pio.c e oled.c, que falam com o PIO e o I2C.
+ *          A matriz guarda as cores num buffer e npWriteAsync() fica
+ *          ocupada pelo tempo que os 25 LEDs levam no fio (24 bits a
+ *          800 kHz mais o reset), para que neopixel_effects.c veja o mesmo
+ *          ritmo da placa. O OLED não desenha nada.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "RP2040_HTTPd_painel_BitDogLab/lib/matrix_led_bitdoglab/neopixel_pio.h"
+#include "oled.h"
+
+// WS2812 frame: 24 bits per LED at 800 kHz, then >= 50 us low
+#define NP_FRAME_US (LED_COUNT * 24 * 10 / 8 + 50)
+
+// ===== Matriz de LEDs =====
+
+static uint8_t np_rgb[LED_COUNT][3];
+static uint64_t np_busy_until_us;
+
+void npInit(uint pin) {
+    (void)pin;
+    npClear();
+}
+
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b) {
+    if (index < LED_COUNT) {
+        np_rgb[index][0] = r;
+        np_rgb[index][1] = g;
+        np_rgb[index][2] = b;
+    }
+}
+
+void npClear(void) {
+    memset(np_rgb, 0, sizeof(np_rgb));
+}
+
+bool npIsBusy(void) {
+    return time_us_64() < np_busy_until_us;
+}
+
+bool npWriteAsync(void) {
+    if (npIsBusy()) {
+        return false;
+    }
+    np_busy_until_us = time_us_64() + NP_FRAME_US;
+    return true;
+}
+
+void npWrite(void) {
+    while (!npWriteAsync()) {
+        tight_loop_contents();
+    }
+    while (npIsBusy()) {
+        tight_loop_contents();
+    }
+}
+
+// ===== OLED =====
+
+void oled_init(void) {
+}
+
+void oled_clear(void) {
+}
+
+void oled_render(void) {
+}
+
+void oled_set_pixel(int x, int y, bool on) {
+    (void)x;
+    (void)y;
+    (void)on;
+}
+
+void oled_draw_line(int x0, int y0, int x1, int y1, bool on) {
+    (void)x0;
+    (void)y0;
+    (void)x1;
+    (void)y1;
+    (void)on;
+}
+
+void oled_draw_char(int x, int y, char c) {
+    (void)x;
+    (void)y;
+    (void)c;
+}
+
+void oled_draw_string(int x, int y, const char *str) {
+    (void)x;
+    (void)y;
+    (void)str;
+}
+
+void oled_draw_big_char(int x, int y, char c) {
+    (void)x;
+    (void)y;
+    (void)c;
+}
+
+void oled_draw_big_string(int x, int y, const char *str) {
+    (void)x;
+    (void)y;
+    (void)str;
+}
+
+void oled_set_text_line(uint8_t line, const char *text, oled_text_alignment_t alignment) {
+    (void)line;
+    (void)text;
+    (void)alignment;
+}
+
+void oled_clear_text_line(uint8_t line) {
+    (void)line;
+}
+
+void oled_render_text(void) {
+}
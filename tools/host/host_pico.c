@@ -0,0 +1,444 @@
+/**
+ * @file    host_pico.c
+ * @brief   Pico SDK e CYW43 simulados para o harness do host
+ * @details Implementa as funções declaradas em tools/host/include:
+ *          - tempo a partir de CLOCK_MONOTONIC, contado do início do processo;
+ *          - alarmes e repeating timers numa tabela fixa, disparados pelo
+ *            mesmo laço que alimenta o lwIP (host_poll());
+ *          - GPIO e ADC com entradas sintéticas (botões pressionados de tempos
+ *            em tempos, joystick em curva lenta, temperatura perto de 27 °C);
+ *          - PWM e clocks sem efeito;
+ *          - o "WiFi": uma interface tap do port unix do lwIP.
+ *
+ *          busy_wait_ms(), sleep_ms() e cyw43_arch_wait_for_work_until()
+ *          rodam host_poll() até o prazo, então o laço principal do firmware
+ *          processa a rede como o modo threadsafe_background faz na placa.
+ *          SIGUSR1 imprime as estatísticas do lwIP (pools, memória, TCP);
+ *          SIGINT/SIGTERM imprimem e encerram.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/stats.h"
+#include "lwip/timeouts.h"
+#include "netif/tapif.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+// Longest wait for a tap frame before the timers are checked again: the
+// input sampler runs every 20 ms
+#define HOST_TICK_MS        5
+
+// Alarms plus repeating timers alive at the same time
+#define HOST_ALARMS         16
+
+// Synthetic inputs
+#define HOST_BTN_PERIOD_MS  5000    // each button is pressed once per period
+#define HOST_BTN_HOLD_MS    250
+#define HOST_JOY_PERIOD_S   7.0
+#define HOST_TEMP_PERIOD_S  60.0
+
+// ===== Tempo =====
+
+static uint64_t host_epoch_us;
+
+static uint64_t host_monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// Time since boot, like the RP2040 timer
+__attribute__((constructor)) static void host_time_init(void) {
+    host_epoch_us = host_monotonic_us();
+}
+
+uint64_t time_us_64(void) {
+    return host_monotonic_us() - host_epoch_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+// ===== Alarmes e repeating timers =====
+
+typedef struct {
+    bool used;
+    uint64_t at_us;
+    alarm_callback_t alarm;             // one-shot alarm, or
+    repeating_timer_t *timer;           // repeating timer
+    void *user_data;
+} host_alarm_t;
+
+static host_alarm_t alarms[HOST_ALARMS];
+
+static alarm_id_t host_alarm_add(uint64_t at_us, alarm_callback_t alarm, repeating_timer_t *timer,
+                                 void *user_data) {
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (!alarms[i].used) {
+            alarms[i] = (host_alarm_t){ true, at_us, alarm, timer, user_data };
+            return i + 1;
+        }
+    }
+    LOG_WARN("[HOST] Sem alarmes livres (HOST_ALARMS = %d)", HOST_ALARMS);
+    return -1;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    return host_alarm_add(time_us_64() + us, callback, NULL, user_data);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    if (alarm_id < 1 || alarm_id > HOST_ALARMS || !alarms[alarm_id - 1].used) {
+        return false;
+    }
+    alarms[alarm_id - 1].used = false;
+    return true;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out) {
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->alarm_id = host_alarm_add(time_us_64() + (uint64_t)llabs(delay_us), NULL, out, user_data);
+    return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out) {
+    return add_repeating_timer_us((int64_t)delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+    bool cancelled = cancel_alarm(timer->alarm_id);
+    timer->alarm_id = 0;
+    return cancelled;
+}
+
+// Fire what is due; callbacks may add or cancel alarms meanwhile
+static void host_run_alarms(void) {
+    uint64_t now = time_us_64();
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        host_alarm_t *a = &alarms[i];
+        if (!a->used || a->at_us > now) {
+            continue;
+        }
+        uint64_t due = a->at_us;
+        if (a->timer != NULL) {
+            repeating_timer_t *t = a->timer;
+            if (!t->callback(t)) {
+                a->used = false;
+                t->alarm_id = 0;
+            } else if (a->used) {
+                // Negative delay: period counted from the previous start
+                a->at_us = (t->delay_us < 0 ? due : time_us_64()) + (uint64_t)llabs(t->delay_us);
+            }
+        } else {
+            a->used = false;
+            int64_t again = a->alarm(i + 1, a->user_data);
+            if (again != 0) {
+                // > 0: from now; < 0: from the time this one was due
+                host_alarm_add((again > 0 ? time_us_64() : due) + (uint64_t)llabs(again), a->alarm, NULL,
+                               a->user_data);
+            }
+        }
+    }
+}
+
+// ===== Laço de rede =====
+
+static bool host_lwip_ready;
+static bool host_net_up;
+static volatile sig_atomic_t host_signal;
+
+// Keeps a lwIP timeout at most HOST_TICK_MS away, so tapif_select() (which
+// sleeps until the next lwIP timeout) returns in time for the alarms
+static void host_tick(void *arg) {
+    (void)arg;
+    sys_timeout(HOST_TICK_MS, host_tick, NULL);
+}
+
+static void host_on_signal(int sig) {
+    host_signal = sig;
+}
+
+static void host_handle_signal(void) {
+    int sig = host_signal;
+    host_signal = 0;
+#if LWIP_STATS && LWIP_STATS_DISPLAY
+    stats_display();
+#else
+    LOG_WARN("[HOST] Estatísticas do lwIP desligadas (LWIP_STATS_DISPLAY)");
+#endif
+    if (sig != SIGUSR1) {
+        exit(0);
+    }
+}
+
+// What the background IRQs do on the board: due alarms, lwIP timeouts and
+// received frames, until the deadline
+static void host_poll(uint64_t until_us) {
+    do {
+        if (host_signal) {
+            host_handle_signal();
+        }
+        host_run_alarms();
+        if (!host_lwip_ready) {
+            usleep(HOST_TICK_MS * 1000);
+            continue;
+        }
+        sys_check_timeouts();
+        if (host_net_up) {
+            tapif_select(&cyw43_state.netif[CYW43_ITF_STA]);
+        } else {
+            usleep(HOST_TICK_MS * 1000);
+        }
+    } while (time_us_64() < until_us);
+}
+
+void busy_wait_us(uint64_t delay_us) {
+    host_poll(time_us_64() + delay_us);
+}
+
+void busy_wait_ms(uint32_t delay_ms) {
+    busy_wait_us((uint64_t)delay_ms * 1000);
+}
+
+void sleep_us(uint64_t us) {
+    busy_wait_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    busy_wait_ms(ms);
+}
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGUSR1, host_on_signal);
+    signal(SIGINT, host_on_signal);
+    signal(SIGTERM, host_on_signal);
+    return true;
+}
+
+// ===== GPIO e ADC sintéticos =====
+
+static uint adc_input;
+
+void gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_set_function(uint gpio, gpio_function_t fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_put(uint gpio, bool value) {
+    (void)gpio;
+    (void)value;
+}
+
+// Buttons are active low: every pin reads "pressed" for HOST_BTN_HOLD_MS once
+// per HOST_BTN_PERIOD_MS, with a phase per pin so they do not move together
+bool gpio_get(uint gpio) {
+    uint32_t ms = (uint32_t)(time_us_64() / 1000) + gpio * 1700u;
+    return (ms % HOST_BTN_PERIOD_MS) >= HOST_BTN_HOLD_MS;
+}
+
+void adc_init(void) {
+}
+
+void adc_gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void adc_select_input(uint input) {
+    adc_input = input;
+}
+
+void adc_set_temp_sensor_enabled(bool enable) {
+    (void)enable;
+}
+
+uint16_t adc_read(void) {
+    double t = time_us_64() / 1e6;
+    switch (adc_input) {
+        case 0:
+        case 1: {
+            // Joystick axes: slow ellipse around the center
+            double phase = 2 * M_PI * t / HOST_JOY_PERIOD_S + (adc_input ? M_PI / 2 : 0);
+            return (uint16_t)(2048 + 1800 * sin(phase));
+        }
+        case 4: {
+            // Inverse of the datasheet formula used by input_sampler.c
+            double temp_c = 27.0 + 1.5 * sin(2 * M_PI * t / HOST_TEMP_PERIOD_S);
+            double voltage = 0.706 - (temp_c - 27.0) * 0.001721;
+            return (uint16_t)(voltage * 4096.0 / 3.3);
+        }
+        default:
+            return 0;
+    }
+}
+
+// ===== PWM e clocks =====
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1) & 7u;
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    (void)slice_num;
+    (void)wrap;
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+    (void)slice_num;
+    (void)integer;
+    (void)fract;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    (void)gpio;
+    (void)level;
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    (void)slice_num;
+    (void)enabled;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    (void)clk_index;
+    return 125000000u;
+}
+
+// ===== CYW43: interface tap no lugar do WiFi =====
+
+cyw43_t cyw43_state;
+
+static const char *host_env(const char *name, const char *fallback) {
+    const char *value = getenv(name);
+    return (value != NULL && value[0] != '\0') ? value : fallback;
+}
+
+int cyw43_arch_init(void) {
+    lwip_init();
+    sys_timeout(HOST_TICK_MS, host_tick, NULL);
+    host_lwip_ready = true;
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    if (host_net_up) {
+        netif_remove(&cyw43_state.netif[CYW43_ITF_STA]);
+        host_net_up = false;
+    }
+}
+
+void cyw43_arch_enable_sta_mode(void) {
+}
+
+// Static address instead of DHCP; the tap device is created by tapif_init()
+// or taken from PRECONFIGURED_TAPIF
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout) {
+    (void)ssid;
+    (void)pw;
+    (void)auth;
+    (void)timeout;
+    ip4_addr_t ip, netmask, gw;
+    if (!ip4addr_aton(host_env("HOST_HTTPD_IP", "192.168.7.2"), &ip) ||
+        !ip4addr_aton(host_env("HOST_HTTPD_NETMASK", "255.255.255.0"), &netmask) ||
+        !ip4addr_aton(host_env("HOST_HTTPD_GW", "192.168.7.1"), &gw)) {
+        LOG_WARN("[HOST] Endereço inválido em HOST_HTTPD_IP/NETMASK/GW");
+        return -1;
+    }
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    const char *hostname = netif_get_hostname(netif); // set by main() before connecting
+    if (netif_add(netif, &ip, &netmask, &gw, NULL, tapif_init, netif_input) == NULL) {
+        LOG_WARN("[HOST] Falha ao abrir a interface tap");
+        return -1;
+    }
+    netif_set_hostname(netif, hostname);
+    netif_set_default(netif);
+    netif_set_up(netif);
+    netif_set_link_up(netif);
+    host_net_up = true;
+    LOG_INFO("[HOST] Interface tap em %s", ip4addr_ntoa(&ip));
+    return 0;
+}
+
+void cyw43_arch_lwip_begin(void) {
+}
+
+void cyw43_arch_lwip_end(void) {
+}
+
+void cyw43_arch_poll(void) {
+    host_poll(0);
+}
+
+void cyw43_arch_wait_for_work_until(absolute_time_t until) {
+    host_poll(until);
+}
+
+void cyw43_gpio_set(cyw43_t *self, int gpio, bool val) {
+    (void)self;
+    (void)gpio;
+    (void)val;
+}
+
+void cyw43_hal_get_mac(int idx, uint8_t buf[6]) {
+    static const uint8_t mac[6] = { 0x02, 0x42, 0xb1, 0x7d, 0x0a, 0x01 };
+    (void)idx;
+    memcpy(buf, mac, sizeof(mac));
+}
+
+// Fixed signal, as a board a few meters from the access point
+int cyw43_wifi_get_rssi(cyw43_t *self, int32_t *rssi) {
+    (void)self;
+    *rssi = -55;
+    return 0;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file    neopixel_pio.h
+ * @brief   Caminho antigo de neopixel_pio.h usado por pico_httpd.c
+ * @details No firmware esse caminho é resolvido a partir do diretório pai
+ *          do workspace; no host aponta para a biblioteca em lib/.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include "../../../../../../lib/matrix_led_bitdoglab/neopixel_pio.h"
@@ -0,0 +1,25 @@
+/**
+ * @file    hardware/adc.h
+ * @brief   ADC do Pico SDK para o harness do host
+ * @details adc_read() devolve valores sintéticos (host_pico.c): o joystick
+ *          descreve uma curva lenta e o sensor de temperatura oscila perto
+ *          de 27 °C.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_ADC_H
+#define HOST_HARDWARE_ADC_H
+
+#include "pico/stdlib.h"
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_temp_sensor_enabled(bool enable);
+uint16_t adc_read(void);
+
+#endif // HOST_HARDWARE_ADC_H
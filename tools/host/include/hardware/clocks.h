@@ -0,0 +1,24 @@
+/**
+ * @file    hardware/clocks.h
+ * @brief   Clocks do Pico SDK para o harness do host (clk_sys de 125 MHz)
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+enum clock_index {
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6,
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+#endif // HOST_HARDWARE_CLOCKS_H
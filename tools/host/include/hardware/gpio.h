@@ -0,0 +1,41 @@
+/**
+ * @file    hardware/gpio.h
+ * @brief   GPIO do Pico SDK para o harness do host
+ * @details Os botões da BitDogLab são simulados em host_pico.c: gpio_get()
+ *          devolve o nível (ativo em LOW) de pressionamentos periódicos.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+#define GPIO_IN     false
+#define GPIO_OUT    true
+
+typedef enum {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_NULL = 0x1f,
+} gpio_function_t;
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_function(uint gpio, gpio_function_t fn);
+void gpio_pull_up(uint gpio);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+
+#endif // HOST_HARDWARE_GPIO_H
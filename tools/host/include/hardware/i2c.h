@@ -0,0 +1,20 @@
+/**
+ * @file    hardware/i2c.h
+ * @brief   I2C do Pico SDK para o harness do host
+ * @details Só os tipos: o OLED é simulado na API de oled.h
+ *          (host_bitdoglab.c) e não chega a usar o barramento.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+#endif // HOST_HARDWARE_I2C_H
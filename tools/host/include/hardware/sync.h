@@ -0,0 +1,31 @@
+/**
+ * @file    hardware/sync.h
+ * @brief   Seções críticas do Pico SDK para o harness do host
+ * @details No host os alarmes e o lwIP rodam na mesma thread, então
+ *          desabilitar interrupções não tem o que fazer.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+// Barreira de memória: basta impedir o compilador de reordenar
+static inline void __dmb(void) {
+    __asm__ volatile("" ::: "memory");
+}
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+#endif // HOST_HARDWARE_SYNC_H
@@ -0,0 +1,16 @@
+/**
+ * @file    hardware/timer.h
+ * @brief   Timer do Pico SDK para o harness do host (ver pico/stdlib.h)
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+#include "pico/stdlib.h"
+
+#endif // HOST_HARDWARE_TIMER_H
@@ -0,0 +1,47 @@
+/**
+ * @file    pico/cyw43_arch.h
+ * @brief   Arquitetura CYW43 do Pico SDK para o harness do host
+ * @details No lugar do WiFi, cyw43_arch_wifi_connect_timeout_ms() adiciona
+ *          uma interface tap (port unix do lwIP) em cyw43_state.netif, com
+ *          o endereço de HOST_HTTPD_IP/HOST_HTTPD_NETMASK/HOST_HTTPD_GW.
+ *          cyw43_arch_lwip_begin()/end() não fazem nada: o lwIP roda no
+ *          laço de busy_wait_ms()/sleep_ms(), na mesma thread do firmware.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_PICO_CYW43_ARCH_H
+#define HOST_PICO_CYW43_ARCH_H
+
+#include "pico/stdlib.h"
+#include "lwip/netif.h"
+
+#define CYW43_ITF_STA               0
+#define CYW43_ITF_AP                1
+#define CYW43_HOST_NAME             "PicoW"
+#define CYW43_HAL_MAC_WLAN0         0
+#define CYW43_AUTH_OPEN             0
+#define CYW43_AUTH_WPA2_AES_PSK     0x00400004
+
+typedef struct {
+    struct netif netif[2];
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+void cyw43_arch_poll(void);
+void cyw43_arch_wait_for_work_until(absolute_time_t until);
+void cyw43_gpio_set(cyw43_t *self, int gpio, bool val);
+void cyw43_hal_get_mac(int idx, uint8_t buf[6]);
+int cyw43_wifi_get_rssi(cyw43_t *self, int32_t *rssi);
+
+#endif // HOST_PICO_CYW43_ARCH_H
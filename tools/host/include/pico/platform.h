@@ -0,0 +1,16 @@
+/**
+ * @file    pico/platform.h
+ * @brief   Plataforma do Pico SDK para o harness do host
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_PICO_PLATFORM_H
+#define HOST_PICO_PLATFORM_H
+
+#include "pico/stdlib.h"
+
+#endif // HOST_PICO_PLATFORM_H
@@ -0,0 +1,16 @@
+/**
+ * @file    pico/sync.h
+ * @brief   Primitivas de sincronização do Pico SDK para o harness do host
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef HOST_PICO_SYNC_H
+#define HOST_PICO_SYNC_H
+
+#include "hardware/sync.h"
+
+#endif // HOST_PICO_SYNC_H
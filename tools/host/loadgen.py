@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+"""
+@file    loadgen.py
+@brief   Gerador de carga para o httpd (host ou placa)
+
+@details Simula N navegadores abertos no painel, com o mesmo padrão de
+         pedidos do app.js:
+           - carga da página: GET / seguido dos CSS, JS e imagens que ela
+             referencia; as recargas mandam If-None-Match com os ETags já
+             vistos, como o cache do navegador;
+           - estado: uma fração dos clientes fica no stream SSE
+             (/api/events), os demais consultam /api/state a cada --poll-ms
+             numa conexão keep-alive, com If-None-Match;
+           - comandos: POSTs de formulário nos CGIs (rgb, matrix, oled,
+             buzzer, fx) com "Prefer: return=minimal", em intervalos
+             exponenciais de média 1/--post-rate por cliente.
+         Só usa a biblioteca padrão (asyncio).
+
+         Ao final imprime, por endpoint: pedidos/s, latência p50/p99,
+         quantas respostas foram 304 e os erros do lado do cliente. Com os
+         pools do lwIP esgotados o servidor recusa conexões ou as derruba, o
+         que aparece aqui como "connect" (timeout ou recusa ao conectar),
+         "reset", "closed" (fechada sem resposta), "timeout" e "5xx". O lado
+         do servidor (campo "err" de cada pool) sai em stats_display() do
+         harness: kill -USR1 <pid>.
+
+         Uso: loadgen.py --host 192.168.7.2 --clients 20 --duration 30
+
+@project BitDogLab_HTTPDd_workspace
+@url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+
+@license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+"""
+
+import argparse
+import asyncio
+import gzip
+import random
+import re
+import time
+
+# Referências locais da página (href/src), sem a query de versão
+ASSET_REF = re.compile(r'(?:href|src)="(/[^"?#]+(?:\?[^"#]*)?)"')
+ASSET_EXT = (".css", ".js", ".png", ".jpg", ".svg", ".ico")
+
+FX_NAMES = ("rainbow", "breathe", "chase", "sparkle", "fire")
+
+
+class HttpError(Exception):
+    """Falha de transporte, com a categoria usada no relatório."""
+
+    def __init__(self, kind):
+        super().__init__(kind)
+        self.kind = kind
+
+
+class Stats:
+    """Latências, códigos e erros por endpoint."""
+
+    def __init__(self):
+        self.latency = {}
+        self.not_modified = {}
+        self.errors = {}
+        self.sse_events = 0
+
+    def ok(self, endpoint, status, seconds):
+        self.latency.setdefault(endpoint, []).append(seconds)
+        if status == 304:
+            self.not_modified[endpoint] = self.not_modified.get(endpoint, 0) + 1
+        elif status >= 500:
+            self.error(endpoint, "5xx")
+
+    def error(self, endpoint, kind):
+        counts = self.errors.setdefault(endpoint, {})
+        counts[kind] = counts.get(kind, 0) + 1
+
+    def report(self, elapsed):
+        def percentile(values, p):
+            return values[min(len(values) - 1, int(p * len(values)))] * 1000
+
+        print("%-16s %8s %8s %9s %9s %6s  %s" % ("endpoint", "pedidos", "req/s", "p50 ms", "p99 ms", "304",
+                                                  "erros"))
+        for endpoint in sorted(set(self.latency) | set(self.errors)):
+            values = sorted(self.latency.get(endpoint, []))
+            errors = ", ".join("%s %d" % item for item in sorted(self.errors.get(endpoint, {}).items()))
+            if values:
+                print("%-16s %8d %8.1f %9.1f %9.1f %6d  %s" % (
+                    endpoint, len(values), len(values) / elapsed, percentile(values, 0.50),
+                    percentile(values, 0.99), self.not_modified.get(endpoint, 0), errors or "-"))
+            else:
+                print("%-16s %8d %8s %9s %9s %6s  %s" % (endpoint, 0, "-", "-", "-", "-", errors))
+        if self.sse_events:
+            print("eventos SSE recebidos: %d" % self.sse_events)
+
+
+class Connection:
+    """Conexão HTTP/1.1 reaproveitada enquanto o servidor a mantiver aberta."""
+
+    def __init__(self, args):
+        self.args = args
+        self.reader = None
+        self.writer = None
+
+    async def open(self):
+        try:
+            self.reader, self.writer = await asyncio.wait_for(
+                asyncio.open_connection(self.args.host, self.args.port), self.args.timeout)
+        except (asyncio.TimeoutError, OSError):
+            raise HttpError("connect")
+
+    def close(self):
+        if self.writer is not None:
+            self.writer.close()
+        self.reader = self.writer = None
+
+    async def request(self, method, path, headers=None, body=b""):
+        lines = ["%s %s HTTP/1.1" % (method, path), "Host: %s" % self.args.host, "Connection: keep-alive",
+                 "Accept-Encoding: gzip, deflate"]  # browsers offer br only over HTTPS
+        lines += ["%s: %s" % item for item in (headers or {}).items()]
+        if method == "POST":
+            lines.append("Content-Length: %d" % len(body))
+        data = ("\r\n".join(lines) + "\r\n\r\n").encode() + body
+        # A kept-alive connection may have been closed by the server while
+        # idle; like browsers, retry once on a fresh one
+        for retry in (True, False):
+            reused = self.writer is not None
+            if not reused:
+                await self.open()
+            try:
+                self.writer.write(data)
+                return await asyncio.wait_for(self.response(), self.args.timeout)
+            except asyncio.TimeoutError:
+                self.close()
+                raise HttpError("timeout")
+            except (ConnectionResetError, BrokenPipeError, asyncio.IncompleteReadError) as e:
+                self.close()
+                if not (reused and retry):
+                    raise HttpError("reset" if isinstance(e, OSError) else "closed")
+
+    async def response(self):
+        version, status = (await self.reader.readuntil(b"\r\n")).split()[:2]
+        status = int(status)
+        headers = {}
+        while True:
+            line = (await self.reader.readuntil(b"\r\n")).decode("latin-1").strip()
+            if not line:
+                break
+            name, _, value = line.partition(":")
+            headers[name.strip().lower()] = value.strip()
+        if "content-length" in headers:
+            body = await self.reader.readexactly(int(headers["content-length"]))
+        elif status in (204, 304):
+            body = b""
+        else:
+            body = await self.reader.read()  # SSI pages: delimited by close
+            self.close()
+            return status, headers, body
+        connection = headers.get("connection", "").lower()
+        if connection == "close" or (version == b"HTTP/1.0" and connection != "keep-alive"):
+            self.close()
+        return status, headers, body
+
+
+def endpoint_of(path):
+    return path.split("?", 1)[0]
+
+
+async def timed(stats, conn, method, path, headers=None, body=b""):
+    """Um pedido medido; devolve (status, cabeçalhos, corpo) ou None."""
+    endpoint = endpoint_of(path)
+    start = time.monotonic()
+    try:
+        status, resp_headers, resp_body = await conn.request(method, path, headers, body)
+    except HttpError as e:
+        stats.error(endpoint, e.kind)
+        return None
+    stats.ok(endpoint, status, time.monotonic() - start)
+    return status, resp_headers, resp_body
+
+
+async def page_load(stats, conn, cache):
+    """GET / e os assets que a página referencia, com If-None-Match."""
+    paths = ["/"]
+    for path in paths:
+        etag, body = cache.get(path, (None, None))
+        result = await timed(stats, conn, "GET", path, {"If-None-Match": etag} if etag else {})
+        if result is None:
+            return
+        status, resp_headers, resp_body = result
+        if status == 200:
+            if resp_headers.get("content-encoding") == "gzip":
+                resp_body = gzip.decompress(resp_body)
+            body = resp_body
+            if "etag" in resp_headers:
+                cache[path] = (resp_headers["etag"], body)
+        if path == "/" and body is not None:
+            paths += [ref for ref in ASSET_REF.findall(body.decode("utf-8", "replace"))
+                      if endpoint_of(ref).endswith(ASSET_EXT)]
+
+
+def random_post():
+    """Um comando como os que o app.js manda, sorteado."""
+    kind = random.choice(("rgb", "matrix", "oled", "buzzer", "fx"))
+    if kind == "rgb":
+        body = "r=%d&g=%d&b=%d" % tuple(random.randrange(256) for _ in range(3))
+    elif kind == "matrix":
+        body = "data=" + "%2C".join("%06x" % random.randrange(1 << 24) for _ in range(25))
+    elif kind == "oled":
+        body = "text=carga+%d" % random.randrange(1000)
+    elif kind == "buzzer":
+        body = "freq=%d&dur=%d&ch=%s" % (random.randrange(200, 2000), random.randrange(20, 200),
+                                         random.choice(("both", "left", "right")))
+    else:
+        body = "fx=%s&color=%06x" % (random.choice(FX_NAMES), random.randrange(1 << 24))
+    return "/%s.cgi" % kind, body.encode()
+
+
+async def poller(stats, args, deadline):
+    conn = Connection(args)
+    cache = {}
+    await page_load(stats, conn, cache)
+    next_reload = time.monotonic() + args.reload_s if args.reload_s else None
+    state_etag = None
+    while time.monotonic() < deadline:
+        if next_reload is not None and time.monotonic() >= next_reload:
+            await page_load(stats, conn, cache)
+            next_reload += args.reload_s
+        headers = {"If-None-Match": state_etag} if state_etag else {}
+        result = await timed(stats, conn, "GET", "/api/state", headers)
+        if result is not None and "etag" in result[1]:
+            state_etag = result[1]["etag"]
+        await asyncio.sleep(args.poll_ms / 1000)
+    conn.close()
+
+
+async def sse_client(stats, args, deadline):
+    conn = Connection(args)
+    await page_load(stats, conn, {})
+    conn.close()
+    while time.monotonic() < deadline:
+        start = time.monotonic()
+        try:
+            await conn.open()
+            conn.writer.write(("GET /api/events HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\n\r\n"
+                               % args.host).encode())
+            head = await asyncio.wait_for(conn.reader.readuntil(b"\r\n\r\n"), args.timeout)
+            status = int(head.split()[1])
+            stats.ok("/api/events", status, time.monotonic() - start)
+            if status != 200:
+                raise HttpError("status %d" % status)
+            while time.monotonic() < deadline:
+                line = await asyncio.wait_for(conn.reader.readline(), max(0.1, deadline - time.monotonic()))
+                if not line:
+                    raise HttpError("closed")
+                if line.startswith(b"event:"):
+                    stats.sse_events += 1
+        except HttpError as e:
+            stats.error("/api/events", e.kind)
+        except asyncio.TimeoutError:
+            if time.monotonic() < deadline:
+                stats.error("/api/events", "timeout")
+        except (ConnectionResetError, BrokenPipeError, asyncio.IncompleteReadError):
+            stats.error("/api/events", "reset")
+        conn.close()
+        await asyncio.sleep(1)  # EventSource retry
+
+
+async def commander(stats, args, deadline):
+    conn = Connection(args)
+    headers = {"Content-Type": "application/x-www-form-urlencoded", "Prefer": "return=minimal"}
+    while True:
+        await asyncio.sleep(random.expovariate(args.post_rate))
+        if time.monotonic() >= deadline:
+            break
+        path, body = random_post()
+        await timed(stats, conn, "POST", path, headers, body)
+    conn.close()
+
+
+async def run(args):
+    stats = Stats()
+    deadline = time.monotonic() + args.duration
+    sse_clients = round(args.clients * args.sse_fraction)
+    tasks = []
+    for i in range(args.clients):
+        # Spread the first page loads over one poll interval
+        await asyncio.sleep(random.uniform(0, args.poll_ms / 1000 / max(1, args.clients)))
+        client = sse_client if i < sse_clients else poller
+        tasks.append(asyncio.create_task(client(stats, args, deadline)))
+        if args.post_rate > 0:
+            tasks.append(asyncio.create_task(commander(stats, args, deadline)))
+    start = time.monotonic()
+    await asyncio.gather(*tasks)
+    stats.report(max(time.monotonic() - start, 1e-3))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2])
+    parser.add_argument("--host", default="192.168.7.2", help="endereço do servidor")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=10, help="navegadores simulados")
+    parser.add_argument("--duration", type=float, default=30, help="duração do teste (s)")
+    parser.add_argument("--poll-ms", type=int, default=200, help="intervalo de /api/state (ms)")
+    parser.add_argument("--post-rate", type=float, default=0.5, help="POSTs por segundo por cliente (0 desliga)")
+    parser.add_argument("--sse-fraction", type=float, default=0.0,
+                        help="fração dos clientes no stream SSE em vez de consultar /api/state")
+    parser.add_argument("--reload-s", type=float, default=0, help="recarrega a página a cada N s (0 desliga)")
+    parser.add_argument("--timeout", type=float, default=5, help="espera máxima por conexão ou resposta (s)")
+    args = parser.parse_args()
+    asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    main()
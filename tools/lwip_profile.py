@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+"""
+@file    lwip_profile.py
+@brief   Dimensiona o heap e os pools do lwIP a partir de uma carga medida
+
+@details Três passos, todos sobre o /metrics do servidor (placa ou harness do
+         host), que expõe uso, máximo, falhas e tamanho do heap e de cada pool:
+
+           measure   roda a carga (um comando, normalmente tools/host/loadgen.py)
+                     contra um firmware compilado com lwipopts_probe.h e grava
+                     a medição em JSON: máximos de cada pool e do heap, pedidos
+                     por URI e o comando que gerou a carga. Um pool que bateu
+                     no teto (máximo igual ao tamanho, ou "err") não mede a
+                     demanda; a gravação sai marcada e o passo falha.
+
+           generate  junta uma ou mais medições (o maior máximo de cada pool) e
+                     escreve um perfil para lwipopts.h: máximo medido mais a
+                     margem, respeitando os mínimos que o próprio lwIP confere
+                     na compilação (MEMP_NUM_TCP_SEG >= TCP_SND_QUEUELEN, pbufs
+                     de recepção para uma janela TCP_WND). Com --baseline (uma
+                     medição do firmware atual) o relatório mostra a SRAM
+                     ganha ou gasta em cada item.
+
+           check     valida o perfil: com o firmware compilado com ele e a
+                     mesma carga, confere que os tamanhos em /metrics são os do
+                     perfil, que nenhum pool ou o heap falhou e que nenhum
+                     chegou ao teto.
+
+         Uso:
+           lwip_profile.py measure -o probe.json -- tools/host/loadgen.py --clients 20
+           lwip_profile.py generate probe.json -o lwipopts_profile.h
+           lwip_profile.py check lwipopts_profile.h -- tools/host/loadgen.py --clients 20
+
+         Os máximos do lwIP contam desde o boot: cada medição deve começar
+         com o firmware recém-iniciado.
+
+@project BitDogLab_HTTPDd_workspace
+@url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+
+@license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+"""
+
+import argparse
+import json
+import math
+import re
+import subprocess
+import sys
+import time
+import urllib.error
+import urllib.request
+
+# Pool do lwIP (nome em memp_std.h) -> opção do lwipopts.h
+POOL_OPTIONS = (
+    ("TCP_PCB", "MEMP_NUM_TCP_PCB"),
+    ("TCP_PCB_LISTEN", "MEMP_NUM_TCP_PCB_LISTEN"),
+    ("TCP_SEG", "MEMP_NUM_TCP_SEG"),
+    ("UDP_PCB", "MEMP_NUM_UDP_PCB"),
+    ("PBUF", "MEMP_NUM_PBUF"),
+    ("ARP_QUEUE", "MEMP_NUM_ARP_QUEUE"),
+    ("PBUF_POOL", "PBUF_POOL_SIZE"),
+)
+HEAP = "heap"
+MEM_SIZE_STEP = 64  # MEM_SIZE arredondado para múltiplos deste valor
+
+SAMPLE = re.compile(r'^([a-zA-Z_:][\w:]*)(?:\{(.*)\})?\s+(\S+)$')
+LABEL = re.compile(r'(\w+)="([^"]*)"')
+
+
+def fetch_metrics(host, port, tries=5):
+    """Texto do /metrics; o servidor responde 503 com as coletas ocupadas."""
+    url = "http://%s:%d/metrics" % (host, port)
+    for attempt in range(tries):
+        try:
+            with urllib.request.urlopen(url, timeout=5) as resp:
+                return resp.read().decode()
+        except (urllib.error.URLError, OSError) as e:
+            if attempt == tries - 1:
+                sys.exit("%s: %s" % (url, e))
+            time.sleep(0.5)
+    return ""
+
+
+def parse_metrics(text):
+    """Heap, pools e pedidos por URI a partir do texto do Prometheus."""
+    fields = {
+        "lwip_mem_used_bytes": "used", "lwip_mem_max_bytes": "max",
+        "lwip_mem_errors_total": "err", "lwip_mem_size_bytes": "size",
+        "lwip_memp_used": "used", "lwip_memp_max": "max", "lwip_memp_errors_total": "err",
+        "lwip_memp_size": "size", "lwip_memp_element_bytes": "element",
+    }
+    pools = {HEAP: {"element": 1}}
+    requests = {}
+    for line in text.splitlines():
+        m = SAMPLE.match(line)
+        if not m:
+            continue
+        name, labels, value = m.group(1), dict(LABEL.findall(m.group(2) or "")), m.group(3)
+        if name == "http_requests_total":
+            requests[labels.get("uri", "?")] = int(float(value))
+        elif name in fields:
+            pool = labels.get("pool", HEAP) if name.startswith("lwip_memp_") else HEAP
+            pools.setdefault(pool, {})[fields[name]] = int(float(value))
+    if "size" not in pools[HEAP]:
+        sys.exit("/metrics sem o tamanho do heap e dos pools (firmware anterior ao lwip_profile.py?)")
+    return pools, requests
+
+
+def saturated(pools):
+    """Itens que bateram no teto: a medição não mostra a demanda deles."""
+    return sorted(name for name, p in pools.items()
+                  if p.get("err", 0) > 0 or (p.get("size", 0) > 0 and p.get("max", 0) >= p["size"]))
+
+
+def run_workload(args):
+    """Roda o comando da carga (se houver) e devolve o /metrics de depois."""
+    before = parse_metrics(fetch_metrics(args.host, args.port))[1]
+    command = args.command
+    start = time.monotonic()
+    if command:
+        status = subprocess.run(command).returncode
+        if status != 0:
+            sys.exit("carga terminou com código %d: %s" % (status, " ".join(command)))
+    duration = time.monotonic() - start
+    pools, after = parse_metrics(fetch_metrics(args.host, args.port))
+    requests = {uri: n - before.get(uri, 0) for uri, n in after.items() if n - before.get(uri, 0) > 0}
+    return {
+        "host": "%s:%d" % (args.host, args.port),
+        "command": command,
+        "recorded": time.strftime("%Y-%m-%d %H:%M:%S"),
+        "duration_s": round(duration, 1),
+        "requests": requests,
+        "pools": pools,
+        "saturated": saturated(pools),
+    }
+
+
+def print_pools(pools, names):
+    print("%-16s %8s %8s %8s %6s" % ("", "máximo", "tamanho", "livre", "err"))
+    for name in names:
+        p = pools.get(name)
+        if p is None:
+            continue
+        size = p.get("size", 0)
+        free = "%5.0f%%" % (100.0 * (size - p["max"]) / size) if size else "-"
+        print("%-16s %8d %8d %8s %6d" % (name, p["max"], size, free, p.get("err", 0)))
+
+
+def cmd_measure(args):
+    rec = run_workload(args)
+    with open(args.output, "w") as f:
+        json.dump(rec, f, indent=2, sort_keys=True)
+    print("%s: %d pedidos em %.1f s" % (args.output, sum(rec["requests"].values()), rec["duration_s"]))
+    print_pools(rec["pools"], [HEAP] + sorted(n for n in rec["pools"] if n != HEAP))
+    if rec["saturated"]:
+        sys.exit("medição inválida, no teto: %s (aumente em lwipopts_probe.h)" % ", ".join(rec["saturated"]))
+
+
+def load_recordings(paths, force):
+    recs = []
+    for path in paths:
+        with open(path) as f:
+            rec = json.load(f)
+        if rec["saturated"] and not force:
+            sys.exit("%s: medição no teto (%s); meça de novo ou use --force" % (path, ", ".join(rec["saturated"])))
+        rec["file"] = path
+        recs.append(rec)
+    return recs
+
+
+def high_water(recs, pool):
+    values = [r["pools"][pool]["max"] for r in recs if pool in r["pools"]]
+    return max(values) if values else None
+
+
+def sized(hw, margin):
+    """Máximo medido mais a margem, sempre acima do máximo."""
+    return max(hw + 1, int(math.ceil(hw * (1.0 + margin))))
+
+
+def cmd_generate(args):
+    recs = load_recordings(args.recordings, args.force)
+    overrides = {}
+    for item in args.set:
+        name, _, value = item.partition("=")
+        if not value.isdigit():
+            sys.exit("--set espera NOME=número: %s" % item)
+        overrides[name] = int(value)
+
+    mss = args.mss
+    wnd = args.wnd_mss * mss
+    snd_buf = args.snd_mss * mss
+    snd_queuelen = (4 * snd_buf + mss - 1) // mss
+    floors = {
+        "MEMP_NUM_TCP_SEG": (snd_queuelen, "TCP_SND_QUEUELEN"),
+        "PBUF_POOL_SIZE": ((wnd + mss - 1) // mss, "TCP_WND"),
+    }
+
+    # (opção, pool, máximo medido, valor, nota)
+    rows = []
+    hw = high_water(recs, HEAP)
+    mem_size = sized(hw, args.margin)
+    mem_size = (mem_size + MEM_SIZE_STEP - 1) // MEM_SIZE_STEP * MEM_SIZE_STEP
+    rows.append(["MEM_SIZE", HEAP, hw, mem_size, ""])
+    for pool, option in POOL_OPTIONS:
+        hw = high_water(recs, pool)
+        if hw is None:
+            continue
+        value, note = sized(hw, args.margin), ""
+        floor, reason = floors.get(option, (1, ""))
+        if value < floor:
+            value, note = floor, "mínimo do lwIP (%s)" % reason
+        rows.append([option, pool, hw, value, note])
+    for row in rows:
+        if row[0] in overrides:
+            row[3], row[4] = overrides.pop(row[0]), "--set"
+    for option, value in sorted(overrides.items()):
+        rows.append([option, None, None, value, "--set"])
+    values = {row[0]: row[3] for row in rows}
+
+    header = render_profile(args, recs, rows)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+    report(args, recs, rows, values, snd_buf)
+
+
+def render_profile(args, recs, rows):
+    out = []
+    w = out.append
+    w("// Gerado por tools/lwip_profile.py a partir de cargas medidas. Não edite:\n")
+    w("// meça de novo e gere outra vez. Uso: -DPICO_HTTPD_LWIP_PROFILE=<este arquivo>\n")
+    w("//\n")
+    for r in recs:
+        w("// %s: %s, %s, %.0f s, %d pedidos\n" % (r["file"], r["host"], r["recorded"], r["duration_s"],
+                                                 sum(r["requests"].values())))
+        if r["command"]:
+            w("//   %s\n" % " ".join(r["command"]))
+    w("// Margem: %d%% sobre o maior máximo de cada item\n\n" % round(args.margin * 100))
+    w("#ifndef LWIPOPTS_PROFILE_H\n#define LWIPOPTS_PROFILE_H\n\n")
+    if args.wnd_mss != 8 or args.snd_mss != 8:
+        w("#define %-28s (%d * TCP_MSS)\n" % ("TCP_WND", args.wnd_mss))
+        w("#define %-28s (%d * TCP_MSS)\n\n" % ("TCP_SND_BUF", args.snd_mss))
+    for option, pool, hw, value, note in rows:
+        comment = "máximo medido %d" % hw if hw is not None else ""
+        if note:
+            comment = "%s; %s" % (comment, note) if comment else note
+        w("#define %-28s %-8d // %s\n" % (option, value, comment))
+    w("\n#endif // LWIPOPTS_PROFILE_H\n")
+    return "".join(out)
+
+
+def report(args, recs, rows, values, snd_buf):
+    """Relatório no stderr: valor novo, atual (--baseline) e SRAM de cada item."""
+    base = None
+    if args.baseline:
+        with open(args.baseline) as f:
+            base = json.load(f)["pools"]
+    err = sys.stderr
+    err.write("%-26s %8s %8s %8s %10s\n" % ("", "máximo", "atual", "perfil", "SRAM"))
+    total = 0
+    for option, pool, hw, value, _ in rows:
+        element = next((r["pools"][pool].get("element", 0) for r in recs if pool in r["pools"]), 0)
+        current = base.get(pool, {}).get("size") if base and pool else None
+        delta = ""
+        if current is not None and element:
+            bytes_delta = (value - current) * element
+            total += bytes_delta
+            delta = "%+d" % bytes_delta
+        err.write("%-26s %8s %8s %8d %10s\n" % (option, "-" if hw is None else hw,
+                                               "-" if current is None else current, value, delta))
+    if base:
+        err.write("%-26s %37s\n" % ("total", "%+d bytes" % total))
+    pcbs = values.get("MEMP_NUM_TCP_PCB")
+    if pcbs and pcbs * snd_buf > values["MEM_SIZE"]:
+        err.write("nota: %d conexões x TCP_SND_BUF (%d) passam de MEM_SIZE; com o heap cheio o tcp_write "
+                  "devolve ERR_MEM e o httpd tenta de novo no próximo poll\n" % (pcbs, snd_buf))
+
+
+def parse_profile(path):
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r'#define\s+(\w+)\s+(\d+)\b', line)
+            if m:
+                defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+def cmd_check(args):
+    defines = parse_profile(args.profile)
+    rec = run_workload(args)
+    pools = rec["pools"]
+    failures = []
+    expected = dict((option, pool) for pool, option in POOL_OPTIONS)
+    expected["MEM_SIZE"] = HEAP
+    for option, value in sorted(defines.items()):
+        pool = expected.get(option)
+        if pool is None or pool not in pools:
+            continue
+        size = pools[pool]["size"]
+        if pool == HEAP:
+            value = (value + 3) // 4 * 4  # MEM_SIZE_ALIGNED
+        if size != value:
+            failures.append("%s: /metrics mostra %d, o perfil tem %d (firmware sem o perfil?)" % (option, size, value))
+    for name in rec["saturated"]:
+        p = pools[name]
+        failures.append("%s: máximo %d de %d, err %d" % (name, p["max"], p["size"], p.get("err", 0)))
+    print_pools(pools, [HEAP] + sorted(n for n in pools if n != HEAP))
+    if failures:
+        sys.exit("perfil reprovado:\n  " + "\n  ".join(failures))
+    print("perfil aprovado: %d pedidos em %.1f s sem falhas de alocação" %
+          (sum(rec["requests"].values()), rec["duration_s"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2])
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    def workload_args(p):
+        p.add_argument("--host", default="192.168.7.2", help="endereço do servidor")
+        p.add_argument("--port", type=int, default=80)
+        p.set_defaults(command=[])
+
+    p = sub.add_parser("measure", help="mede os máximos sob uma carga (-- comando da carga)")
+    p.add_argument("-o", "--output", required=True, help="medição (JSON)")
+    workload_args(p)
+    p.set_defaults(func=cmd_measure)
+
+    p = sub.add_parser("generate", help="gera o perfil a partir das medições")
+    p.add_argument("recordings", nargs="+", help="medições (JSON) de measure")
+    p.add_argument("-o", "--output", help="perfil gerado (padrão: stdout)")
+    p.add_argument("--margin", type=float, default=0.25, help="folga sobre o máximo medido (fração)")
+    p.add_argument("--mss", type=int, default=1460, help="TCP_MSS do lwipopts.h")
+    p.add_argument("--wnd-mss", type=int, default=8, help="TCP_WND em MSS (diferente de 8 entra no perfil)")
+    p.add_argument("--snd-mss", type=int, default=8, help="TCP_SND_BUF em MSS (diferente de 8 entra no perfil)")
+    p.add_argument("--set", action="append", default=[], metavar="NOME=VALOR",
+                   help="fixa uma opção (ex.: MEMP_NUM_TCP_PCB=16 para mais conexões)")
+    p.add_argument("--baseline", help="medição do firmware atual, para o relatório de SRAM")
+    p.add_argument("--force", action="store_true", help="aceita medições no teto")
+    p.set_defaults(func=cmd_generate)
+
+    p = sub.add_parser("check", help="valida o perfil sob a mesma carga (-- comando da carga)")
+    p.add_argument("profile", help="perfil gerado")
+    workload_args(p)
+    p.set_defaults(func=cmd_check)
+
+    # Tudo depois de "--" é o comando da carga
+    argv = sys.argv[1:]
+    split = argv.index("--") if "--" in argv else len(argv)
+    args = parser.parse_args(argv[:split])
+    args.command = argv[split + 1:]
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,731 @@
+#!/usr/bin/env python3
+"""
+@file    makefsdata.py
+@brief   Pipeline de assets do httpd: minifica, comprime e gera o fsdata
+
+@details Substitui o makefsdata do SDK. Para cada arquivo de content/:
+           - arquivos .gz de entrada são descomprimidos e tratados pelo nome
+             original (ex.: img/rpi.png.gz é servido como /img/rpi.png);
+           - HTML, CSS e JS são minificados de forma conservadora;
+           - arquivos com tags SSI (<!--#) recebem FS_FILE_FLAGS_SSI e são
+             enviados sem compressão, já que o httpd precisa varrê-los;
+           - os demais são comprimidos com gzip quando isso reduz o tamanho
+             e servidos com Content-Encoding: gzip, sem varredura de tags.
+         O cabeçalho HTTP de cada arquivo é gerado aqui e embutido no fsdata
+         (lwipopts.h usa LWIP_HTTPD_SSI_BY_FILE_EXTENSION 0, então é a flag
+         por arquivo que decide a varredura). Ao final imprime os bytes de
+         cada etapa por arquivo.
+
+         Cache: cada arquivo estático recebe um ETag (hash do corpo final) e
+         entra na tabela http_cache_files com a resposta 304 pronta. Os
+         assets referenciados por outro arquivo ("/css/style.css") têm a
+         referência reescrita para "/css/style.css?v=<etag>" e são servidos
+         com Cache-Control imutável de um ano; os demais são revalidados a
+         cada uso (no-cache + If-None-Match). Arquivos com SSI saem com
+         no-store e sem ETag.
+
+         Keep-alive: os arquivos estáticos saem com "Connection: keep-alive".
+         Para o último pedido de uma conexão (HTTP_KEEPALIVE_MAX_REQUESTS) são
+         gravados também um cabeçalho e um 304 com "Connection: close"; o
+         corpo não é duplicado (tabela http_keepalive_files, ver
+         http_keepalive.h).
+
+         Com --checksum-chunk <TCP_MSS> a resposta de cada arquivo estático
+         (cabeçalho incluído) é dividida em blocos desse tamanho e o checksum
+         TCP de cada bloco é gravado no fsdata, para HTTPD_PRECALCULATED_CHECKSUM
+         (ver http_chksum.h).
+
+         Codificações: cada arquivo estático pode ter mais de uma variante
+         gravada (gzip; br com --brotli; sem compressão com --identity). A
+         variante preferida (gzip, se reduzir o tamanho) é a entrada normal do
+         fsdata; as demais ficam fora da lista e entram na tabela
+         http_encoding_files, de onde http_encoding.c escolhe pelo
+         Accept-Encoding. Arquivos com mais de uma variante saem com
+         "Vary: Accept-Encoding" e um ETag por variante. O relatório mostra o
+         custo em flash de cada conjunto de variantes, inclusive das que não
+         foram gravadas.
+
+         Com --bundle cada página sem SSI vira um documento único: as folhas
+         de estilo (<link rel="stylesheet">) entram num <style>, os scripts
+         (<script src>) entram inline e as imagens de até --inline-max bytes
+         referenciadas pela página ou pelo CSS viram data: URIs. Os assets
+         que só eram usados assim saem do fsdata. O relatório mostra, por
+         página, bytes e pedidos antes e depois.
+
+         Uso: makefsdata.py --root <content> --output <pico_fsdata.inc>
+                            [--checksum-chunk <bytes>] [--brotli] [--identity]
+                            [--bundle [--inline-max <bytes>]] arquivos...
+
+@project BitDogLab_HTTPDd_workspace
+@url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+
+@license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+"""
+
+import argparse
+import base64
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+SERVER = "lwIP/2.2.0 (BitDogLab)"
+
+# Alinhamento do nome dentro do bloco de dados (como o makefsdata do lwIP)
+NAME_ALIGNMENT = 4
+
+# Flags de fsdata.h
+FS_FILE_FLAGS_HEADER_INCLUDED = 0x01
+FS_FILE_FLAGS_HEADER_PERSISTENT = 0x02
+FS_FILE_FLAGS_HEADER_HTTPVER_1_1 = 0x04
+FS_FILE_FLAGS_SSI = 0x08
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".shtml": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+    ".svg": "image/svg+xml",
+    ".txt": "text/plain",
+}
+
+SSI_TAG = b"<!--#"
+
+CACHE_IMMUTABLE = "public, max-age=31536000, immutable"
+CACHE_REVALIDATE = "no-cache"
+CACHE_DYNAMIC = "no-store"
+
+# Codificações na ordem de preferência (e de http_encoding_t); None é o
+# arquivo sem compressão (identity)
+ENCODINGS = ("br", "gzip", None)
+
+# Caracteres hex do ETag (sha256 truncado)
+ETAG_DIGITS = 16
+
+# Ordem de processamento: um arquivo só pode apontar para a versão de um
+# asset que já tenha ETag, então imagens vêm antes de CSS, CSS antes de JS
+# e as páginas por último
+PROCESS_ORDER = {".css": 1, ".js": 2, ".html": 3, ".shtml": 3}
+
+
+def minify_html(text):
+    # Comentários saem, tags SSI ficam
+    text = re.sub(r"<!--(?!#).*?-->", "", text, flags=re.S)
+    lines = []
+    raw = False
+    for line in text.split("\n"):
+        if raw:
+            lines.append(line)
+        elif line.strip():
+            lines.append(line.strip())
+        # Conteúdo de <pre>/<textarea> é copiado sem alteração
+        if re.search(r"<(pre|textarea)\b", line, re.I):
+            raw = True
+        if re.search(r"</(pre|textarea)>", line, re.I):
+            raw = False
+    return "\n".join(lines) + "\n"
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{};,>])\s*", r"\1", text)
+    # Só o espaço depois de ':'; antes dele pode ser um seletor ("a :hover")
+    text = re.sub(r":\s+", ":", text)
+    return text.replace(";}", "}").strip() + "\n"
+
+
+def minify_js(text):
+    # Sem reescrever o código: remove comentários de bloco no início de
+    # linha, comentários de linha inteira, indentação e linhas vazias. Linhas
+    # dentro de template literals de várias linhas são mantidas.
+    lines = []
+    in_template = False
+    in_comment = False
+    for line in text.split("\n"):
+        stripped = line.strip()
+        if in_template:
+            lines.append(line)
+        elif in_comment:
+            if "*/" in stripped:
+                in_comment = False
+                rest = stripped.split("*/", 1)[1].strip()
+                if rest:
+                    lines.append(rest)
+            continue
+        elif stripped.startswith("/*"):
+            if "*/" not in stripped:
+                in_comment = True
+            else:
+                rest = stripped.split("*/", 1)[1].strip()
+                if rest:
+                    lines.append(rest)
+            continue
+        elif stripped and not stripped.startswith("//"):
+            lines.append(stripped)
+        if len(re.findall(r"(?<!\\)`", line)) % 2:
+            in_template = not in_template
+    return "\n".join(lines) + "\n"
+
+
+MINIFIERS = {
+    ".html": minify_html,
+    ".shtml": minify_html,
+    ".css": minify_css,
+    ".js": minify_js,
+}
+
+
+def build_header(status, content_type, length, encoding, etag, cache_control, vary, persistent=True):
+    reason = {200: "OK", 404: "File not found"}[status]
+    header = "HTTP/1.1 %d %s\r\n" % (status, reason)
+    header += "Server: %s\r\n" % SERVER
+    # Sem Content-Length o fim da resposta é o fechamento da conexão
+    if length is not None:
+        header += "Content-Length: %d\r\n" % length
+        header += "Connection: %s\r\n" % ("keep-alive" if persistent else "close")
+    else:
+        header += "Connection: close\r\n"
+    header += "Content-Type: %s\r\n" % content_type
+    if encoding:
+        header += "Content-Encoding: %s\r\n" % encoding
+    header += cache_headers(etag, cache_control, vary)
+    header += "\r\n"
+    return header.encode("ascii")
+
+
+def cache_headers(etag, cache_control, vary):
+    header = ""
+    if vary:
+        header += "Vary: Accept-Encoding\r\n"
+    if etag:
+        header += "ETag: %s\r\n" % etag
+    if cache_control:
+        header += "Cache-Control: %s\r\n" % cache_control
+    return header
+
+
+def build_not_modified(etag, cache_control, vary, persistent=True):
+    header = "HTTP/1.1 304 Not Modified\r\n"
+    header += "Server: %s\r\n" % SERVER
+    header += "Connection: %s\r\n" % ("keep-alive" if persistent else "close")
+    header += cache_headers(etag, cache_control, vary)
+    header += "\r\n"
+    return header
+
+
+def load(root, path):
+    rel = os.path.relpath(path, root).replace(os.sep, "/")
+    with open(path, "rb") as f:
+        source = f.read()
+    data = source
+    name = rel
+    if name.endswith(".gz"):
+        name = name[:-3]
+        data = gzip.decompress(data)
+    return {"name": "/" + name, "ext": os.path.splitext(name)[1].lower(), "source": source, "raw": data}
+
+
+def reference_pattern(name):
+    # Absolute reference between quotes or url(...), without a query yet
+    return re.compile(r"""(["'(])%s(?=["')])""" % re.escape(name))
+
+
+def referenced_names(files):
+    texts = [f["raw"].decode("utf-8") for f in files if f["ext"] in MINIFIERS]
+    return {f["name"] for f in files if any(reference_pattern(f["name"]).search(t) for t in texts)}
+
+
+def rewrite_references(text, etags):
+    # httpd drops the query before the file lookup, so the versioned URL
+    # serves the same file while being a new cache entry for the browser
+    for name, etag in etags.items():
+        text = reference_pattern(name).sub(r"\g<1>%s?v=%s" % (name, etag), text)
+    return text
+
+
+def compress(data, encoding):
+    if encoding == "gzip":
+        return gzip.compress(data, 9, mtime=0)
+    try:
+        import brotli
+    except ImportError:
+        return None
+    return brotli.compress(data, quality=11)
+
+
+def asset_pattern(name):
+    # Reference between quotes or url(...), versioned or not
+    return re.compile(r"""(["'(])%s(?:\?v=[0-9a-f]+)?(?=["')])""" % re.escape(name))
+
+
+LINK_TAG = re.compile(r"<link\b[^>]*>", re.I)
+LINK_HREF = re.compile(r"""\bhref=["'](/[^"'?]+)["']""", re.I)
+LINK_STYLESHEET = re.compile(r"""\brel=["']?stylesheet\b""", re.I)
+SCRIPT_TAG = re.compile(r"""<script\b([^>]*?)\s*\bsrc=["'](/[^"'?]+)["']([^>]*)>\s*</script>""", re.I)
+
+
+class Bundler:
+    """Embute CSS, JS e imagens pequenas nas páginas (--bundle)."""
+
+    def __init__(self, files, inline_max):
+        self.assets = {f["name"]: f for f in files}
+        self.inline_max = inline_max
+        self.inlined = {}               # página -> assets embutidos
+
+    def data_uri(self, f):
+        content_type = CONTENT_TYPES.get(f["ext"], "application/octet-stream")
+        return "data:%s;base64,%s" % (content_type, base64.b64encode(f["raw"]).decode("ascii"))
+
+    def images(self, text, inlined):
+        for name, f in self.assets.items():
+            if f["ext"] in MINIFIERS or len(f["raw"]) > self.inline_max:
+                continue
+            pattern = asset_pattern(name)
+            if pattern.search(text):
+                text = pattern.sub(lambda m: m.group(1) + self.data_uri(f), text)
+                inlined.add(name)
+        return text
+
+    def page(self, f, text):
+        """Recebe o HTML já minificado; CSS e JS vêm minificados do process()
+        de cada um, que roda antes das páginas (PROCESS_ORDER)."""
+        inlined = self.inlined.setdefault(f["name"], set())
+
+        def style(m):
+            href = LINK_HREF.search(m.group(0))
+            if not LINK_STYLESHEET.search(m.group(0)) or not href or href.group(1) not in self.assets:
+                return m.group(0)
+            inlined.add(href.group(1))
+            css = self.images(self.assets[href.group(1)]["text"], inlined).strip()
+            return "<style>%s</style>" % re.sub(r"</(style)", lambda e: "<\\/" + e.group(1), css, flags=re.I)
+
+        def script(m):
+            if m.group(2) not in self.assets:
+                return m.group(0)
+            inlined.add(m.group(2))
+            # defer/async make no sense without src; the tag stays where it was
+            attrs = re.sub(r"\s*\b(defer|async)\b", "", m.group(1) + m.group(3)).rstrip()
+            js = self.assets[m.group(2)]["text"].rstrip("\n")
+            return "<script%s>%s</script>" % (attrs, re.sub(r"</(script)", lambda e: "<\\/" + e.group(1), js,
+                                                            flags=re.I))
+
+        text = LINK_TAG.sub(style, text)
+        text = SCRIPT_TAG.sub(script, text)
+        return self.images(text, inlined)
+
+    def prune(self, files):
+        """Tira do fsdata os assets embutidos que nenhum arquivo mantido
+        ainda referencia."""
+        inlined = set().union(*self.inlined.values()) if self.inlined else set()
+        kept = [f for f in files if f["name"] not in inlined]
+        texts = [f["text"] for f in kept if "text" in f]
+        return [f for f in files
+                if f["name"] not in inlined or any(asset_pattern(f["name"]).search(t) for t in texts)]
+
+    def report(self, files):
+        emitted = {f["name"]: f for f in files}
+        for page, inlined in self.inlined.items():
+            if not inlined:
+                continue
+            f = emitted[page]
+            before = f["unbundled_len"] + sum(len(self.assets[n]["reps"][0]["body"]) for n in inlined)
+            external = [n for n in emitted if n != page and asset_pattern(n).search(f["text"])]
+            print("bundle %s: %d pedido(s), antes %d; %d bytes, antes %d (embutidos: %s)"
+                  % (page, 1 + len(external), 1 + len(inlined) + len(external), len(f["reps"][0]["body"]),
+                     before, ", ".join(sorted(inlined)) or "nenhum"))
+
+
+def process(f, etags, referenced, stored, bundler=None):
+    name, ext, data = f["name"], f["ext"], f["raw"]
+    raw_len = len(data)
+    if ext in MINIFIERS:
+        text = data.decode("utf-8")
+        if bundler and ext in (".html", ".shtml") and SSI_TAG not in data:
+            minified = MINIFIERS[ext](text)
+            # Separate-file size of the page, for the report
+            f["unbundled_len"] = len(gzip.compress(rewrite_references(minified, etags).encode("utf-8"), 9, mtime=0))
+            text = rewrite_references(bundler.page(f, minified), etags)
+        else:
+            text = MINIFIERS[ext](rewrite_references(text, etags))
+        f["text"] = text
+        data = text.encode("utf-8")
+    minified_len = len(data)
+
+    flags = FS_FILE_FLAGS_HEADER_INCLUDED | FS_FILE_FLAGS_HEADER_HTTPVER_1_1
+    # Candidatas: compressões que reduzem o tamanho, mais o original
+    candidates = {None: data}
+    if SSI_TAG in data:
+        # O tamanho final depende das tags: sem Content-Length, sem gzip
+        flags |= FS_FILE_FLAGS_SSI
+    else:
+        flags |= FS_FILE_FLAGS_HEADER_PERSISTENT
+        for encoding in ENCODINGS:
+            packed = compress(data, encoding) if encoding else None
+            if packed is not None and len(packed) < len(data):
+                candidates[encoding] = packed
+
+    # A variante do fsdata é gzip quando existe; as outras só se pedidas
+    default = "gzip" if "gzip" in candidates else None
+    encodings = [e for e in ENCODINGS if e in candidates and (e == default or e in stored)]
+    vary = len(encodings) > 1
+
+    status = 404 if os.path.basename(name).startswith("404") else 200
+    cache_control = None
+    if flags & FS_FILE_FLAGS_SSI:
+        cache_control = CACHE_DYNAMIC
+    elif status == 200:
+        cache_control = CACHE_IMMUTABLE if name in referenced else CACHE_REVALIDATE
+
+    content_type = CONTENT_TYPES.get(ext, "application/octet-stream")
+    reps = []
+    for encoding in [default] + [e for e in encodings if e != default]:
+        body = candidates[encoding]
+        length = None if flags & FS_FILE_FLAGS_SSI else len(body)
+        etag = None
+        if cache_control != CACHE_DYNAMIC and status == 200:
+            digest = hashlib.sha256(body).hexdigest()[:ETAG_DIGITS]
+            etag = "\"%s\"" % digest
+            if encoding == default:
+                etags[name] = digest
+        # Variantes "Connection: close" para o último pedido de uma conexão
+        # persistente (HTTP_KEEPALIVE_MAX_REQUESTS); só o cabeçalho é gravado
+        # de novo, o corpo é lido da entrada do fsdata
+        reps.append({
+            "encoding": encoding,
+            "header": build_header(status, content_type, length, encoding, etag, cache_control, vary),
+            "header_close": build_header(status, content_type, length, encoding, etag, cache_control, vary,
+                                         persistent=False) if length is not None else None,
+            "body": body,
+            "etag": etag,
+            "not_modified": build_not_modified(etag, cache_control, vary) if etag else None,
+            "not_modified_close": build_not_modified(etag, cache_control, vary, persistent=False) if etag else None,
+        })
+
+    # Custo em flash de cada candidata, cabeçalho incluído; as não gravadas
+    # são medidas com o cabeçalho que teriam
+    flash = {r["encoding"]: len(r["header"]) + len(r["body"]) for r in reps}
+    for encoding, body in candidates.items():
+        if encoding not in flash:
+            flash[encoding] = len(body) + len(build_header(status, content_type, len(body), encoding,
+                                                           reps[0]["etag"], cache_control, True))
+
+    f.update({
+        "reps": reps,
+        "flags": flags,
+        "cache": cache_control,
+        "flash": flash,
+        "stats": (len(f["source"]), raw_len, minified_len, len(reps[0]["body"]), default),
+    })
+
+
+def chksum(data):
+    """Soma em complemento de um, não invertida, como lwip_standard_chksum()
+    em um alvo little-endian (Cortex-M0+)."""
+    if len(data) % 2:
+        data += b"\0"
+    total = sum(data[i] | data[i + 1] << 8 for i in range(0, len(data), 2))
+    while total >> 16:
+        total = (total & 0xFFFF) + (total >> 16)
+    return total
+
+
+def chksum_blocks(data, chunk):
+    return [(offset, chksum(data[offset:offset + chunk]), len(data[offset:offset + chunk]))
+            for offset in range(0, len(data), chunk)]
+
+
+def c_ident(name):
+    return re.sub(r"\W", "_", name)
+
+
+def c_bytes(data):
+    out = []
+    for i in range(0, len(data), 16):
+        out.append("".join("0x%02x," % b for b in data[i:i + 16]))
+    return "\n".join(out)
+
+
+def c_string(text):
+    return "\"%s\"" % text.replace("\\", "\\\\").replace("\"", "\\\"").replace("\r", "\\r").replace("\n", "\\n")
+
+
+def flag_names(flags):
+    names = []
+    if flags & FS_FILE_FLAGS_HEADER_INCLUDED:
+        names.append("FS_FILE_FLAGS_HEADER_INCLUDED")
+    if flags & FS_FILE_FLAGS_HEADER_PERSISTENT:
+        names.append("FS_FILE_FLAGS_HEADER_PERSISTENT")
+    if flags & FS_FILE_FLAGS_HEADER_HTTPVER_1_1:
+        names.append("FS_FILE_FLAGS_HEADER_HTTPVER_1_1")
+    if flags & FS_FILE_FLAGS_SSI:
+        names.append("FS_FILE_FLAGS_SSI")
+    return " | ".join(names)
+
+
+# Abre um arquivo do fsdata por fs_open_custom() com flags diferentes
+FSDATA_OPEN = """// Arquivo do fsdata com flags alteradas, aberto por fs_open_custom()
+int http_fsdata_open_file(struct fs_file *file, const struct fsdata_file *f, u8_t clear_flags) {
+    memset(file, 0, sizeof(struct fs_file));
+    file->data = (const char *)f->data;
+    file->len = f->len;
+    file->index = f->len;
+    file->flags = f->flags & ~clear_flags;
+#if HTTPD_PRECALCULATED_CHECKSUM
+    file->chksum_count = f->chksum_count;
+    file->chksum = f->chksum;
+#endif
+    return 1;
+}
+
+int http_fsdata_open(struct fs_file *file, const char *name, u8_t clear_flags) {
+    for (const struct fsdata_file *f = FS_ROOT; f != NULL; f = f->next) {
+        if (strcmp((const char *)f->name, name) == 0) {
+            return http_fsdata_open_file(file, f, clear_flags);
+        }
+    }
+    return 0;
+}
+
+"""
+
+
+def encoding_name(encoding):
+    return encoding or "identity"
+
+
+def write_fsdata(out, files, chunk):
+    w = out.write
+    w("// Gerado por tools/makefsdata.py a partir de content/. Não edite.\n\n")
+    w("#include \"lwip/apps/fs.h\"\n")
+    w("#include \"lwip/def.h\"\n")
+    w("#include \"http_cache.h\"\n")
+    w("#include \"http_chksum.h\"\n")
+    w("#include \"http_encoding.h\"\n")
+    w("#include \"http_keepalive.h\"\n")
+    w("#include <string.h>\n\n")
+    w("#ifndef FSDATA_ALIGN_PRE\n#define FSDATA_ALIGN_PRE\n#endif\n")
+    w("#ifndef FSDATA_ALIGN_POST\n#define FSDATA_ALIGN_POST\n#endif\n\n")
+    w("#define file_NULL (struct fsdata_file *) NULL\n\n")
+    if chunk:
+        w("#if HTTPD_PRECALCULATED_CHECKSUM && TCP_MSS != %d\n" % chunk)
+        w("#error \"checksums do fsdata gerados para blocos de %d bytes, diferente de TCP_MSS\"\n#endif\n\n" % chunk)
+
+    # The first representation is the fsdata entry; the other encodings get
+    # a suffix and stay out of the FS_ROOT list
+    reps = []
+    for f in files:
+        name = f["name"].encode("ascii") + b"\0"
+        name += b"\0" * (-len(name) % NAME_ALIGNMENT)
+        for i, r in enumerate(f["reps"]):
+            r["ident"] = c_ident(f["name"]) + ("_" + encoding_name(r["encoding"]) if i else "")
+            r["name"] = name
+            r["file"] = f
+            reps.append(r)
+        f["ident"] = f["reps"][0]["ident"]
+
+    for r in reps:
+        w("static const unsigned char FSDATA_ALIGN_PRE data_%s[] FSDATA_ALIGN_POST = {\n" % r["ident"])
+        w("/* %s (%d chars) */\n%s\n" % (r["file"]["name"], len(r["name"]), c_bytes(r["name"])))
+        w("/* HTTP header (%s) */\n%s\n" % (encoding_name(r["encoding"]), c_bytes(r["header"])))
+        w("/* raw file data (%d bytes) */\n%s\n};\n\n" % (len(r["body"]), c_bytes(r["body"])))
+
+    # Só arquivos estáticos: os com SSI são enviados picados pelas tags
+    for r in reps:
+        r["blocks"] = []
+        if chunk and not r["file"]["flags"] & FS_FILE_FLAGS_SSI:
+            r["blocks"] = chksum_blocks(r["header"] + r["body"], chunk)
+    if chunk:
+        w("#if HTTPD_PRECALCULATED_CHECKSUM\n")
+        for r in reps:
+            if r["blocks"]:
+                w("static const struct fsdata_chksum chksums_%s[] = {\n" % r["ident"])
+                for offset, value, length in r["blocks"]:
+                    w("    { %d, 0x%04x, %d },\n" % (offset, value, length))
+                w("};\n")
+        w("#endif\n\n")
+
+    prev = "file_NULL"
+    for r in reps:
+        listed = r is r["file"]["reps"][0]
+        w("%sconst struct fsdata_file file_%s[] = { {\n" % ("" if listed else "static ", r["ident"]))
+        w("%s,\ndata_%s,\ndata_%s + %d,\nsizeof(data_%s) - %d,\n%s\n"
+          % (prev if listed else "file_NULL", r["ident"], r["ident"], len(r["name"]), r["ident"], len(r["name"]),
+             flag_names(r["file"]["flags"])))
+        if r["blocks"]:
+            w("#if HTTPD_PRECALCULATED_CHECKSUM\n, %d, chksums_%s\n#endif\n}};\n\n" % (len(r["blocks"]), r["ident"]))
+        else:
+            w("#if HTTPD_PRECALCULATED_CHECKSUM\n, 0, NULL\n#endif\n}};\n\n")
+        if listed:
+            prev = "file_%s" % r["ident"]
+
+    w("#define FS_ROOT %s\n" % prev)
+    w("#define FS_NUMFILES %d\n\n" % len(files))
+
+    w(FSDATA_OPEN)
+
+    # One entry per representation, the fsdata one first, so the lookup by
+    # name in http_cache_open() finds the default encoding
+    cached = [r for r in reps if r["etag"]]
+    w("// ETag e respostas 304 de cada arquivo estático (http_cache.c)\n")
+    w("const http_cache_file_t http_cache_files[] = {\n")
+    for i, r in enumerate(cached):
+        r["cache_index"] = i
+        w("    { \"%s\", %s,\n      %s, %d,\n      %s, %d },\n"
+          % (r["file"]["name"], c_string(r["etag"]), c_string(r["not_modified"]), len(r["not_modified"]),
+             c_string(r["not_modified_close"]), len(r["not_modified_close"])))
+    if not cached:
+        w("    { NULL, NULL, NULL, 0, NULL, 0 },\n")
+    w("};\n")
+    w("const uint16_t http_cache_file_count = %d;\n\n" % len(cached))
+
+    # Same order as the cache table: the fsdata entry of a name comes first
+    closing = [r for r in reps if r["header_close"]]
+    w("// Cabeçalho \"Connection: close\" de cada arquivo estático (http_keepalive.c)\n")
+    w("const http_keepalive_file_t http_keepalive_files[] = {\n")
+    for i, r in enumerate(closing):
+        r["keepalive_index"] = i
+        w("    { \"%s\",\n      %s, %d,\n      data_%s + %d, %d },\n"
+          % (r["file"]["name"], c_string(r["header_close"].decode("ascii")), len(r["header_close"]),
+             r["ident"], len(r["name"]) + len(r["header"]), len(r["body"])))
+    if not closing:
+        w("    { NULL, NULL, 0, NULL, 0 },\n")
+    w("};\n")
+    w("const uint16_t http_keepalive_file_count = %d;\n\n" % len(closing))
+
+    negotiated = [f for f in files if len(f["reps"]) > 1]
+    w("// Variantes por codificação dos arquivos com mais de uma (http_encoding.c)\n")
+    w("const http_encoding_file_t http_encoding_files[] = {\n")
+    for f in negotiated:
+        by_encoding = {r["encoding"]: r for r in f["reps"]}
+        w("    { \"%s\", HTTP_ENCODING_%s, {\n" % (f["name"], encoding_name(f["reps"][0]["encoding"]).upper()))
+        for encoding in ENCODINGS:
+            r = by_encoding.get(encoding)
+            if r is None:
+                w("        { NULL, NULL, NULL },\n")
+            else:
+                cache = "&http_cache_files[%d]" % r["cache_index"] if r["etag"] else "NULL"
+                last = "&http_keepalive_files[%d]" % r["keepalive_index"] if r["header_close"] else "NULL"
+                w("        { file_%s, %s, %s },\n" % (r["ident"], cache, last))
+        w("    } },\n")
+    if not negotiated:
+        w("    { NULL, HTTP_ENCODING_IDENTITY, { { NULL, NULL, NULL } } },\n")
+    w("};\n")
+    w("const uint16_t http_encoding_file_count = %d;\n\n" % len(negotiated))
+
+    summed = [r for r in reps if r["blocks"]]
+    w("#if HTTPD_PRECALCULATED_CHECKSUM\n")
+    w("// Blocos com checksum pré-calculado de cada arquivo (http_chksum.c)\n")
+    w("const http_chksum_file_t http_chksum_files[] = {\n")
+    for r in summed:
+        w("    { data_%s + %d, sizeof(data_%s) - %d, chksums_%s, %d },\n"
+          % (r["ident"], len(r["name"]), r["ident"], len(r["name"]), r["ident"], len(r["blocks"])))
+    if not summed:
+        w("    { NULL, 0, NULL, 0 },\n")
+    w("};\n")
+    w("const uint16_t http_chksum_file_count = %d;\n" % len(summed))
+    w("#endif\n")
+
+
+def report(files):
+    print("%-20s %8s %8s %8s %8s  %s" % ("asset", "fonte", "original", "minif.", "final", "flags"))
+    totals = [0, 0, 0, 0]
+    for f in files:
+        source, raw, minified, final, encoding = f["stats"]
+        tags = ["ssi" if f["flags"] & FS_FILE_FLAGS_SSI else "static"]
+        if encoding:
+            tags.append(encoding)
+        if len(f["reps"]) > 1:
+            tags.append("+".join(encoding_name(r["encoding"]) for r in f["reps"][1:]))
+        if f["cache"] == CACHE_IMMUTABLE:
+            tags.append("imutável")
+        elif f["reps"][0]["etag"]:
+            tags.append("etag")
+        print("%-20s %8d %8d %8d %8d  %s" % (f["name"], source, raw, minified, final, ",".join(tags)))
+        totals = [a + b for a, b in zip(totals, (source, raw, minified, final))]
+    print("%-20s %8d %8d %8d %8d" % ("total", *totals))
+
+    # Flash por conjunto de variantes; entre parênteses as não gravadas
+    print()
+    print("%-20s %10s %10s %10s" % ("flash (c/ cabeçalho)", *(encoding_name(e) for e in ENCODINGS)))
+    stored_total = {e: 0 for e in ENCODINGS}
+    extra_total = {e: 0 for e in ENCODINGS}
+    for f in files:
+        stored = {r["encoding"] for r in f["reps"]}
+        cells = []
+        for e in ENCODINGS:
+            if e in stored:
+                stored_total[e] += f["flash"][e]
+                cells.append("%d" % f["flash"][e])
+            elif e in f["flash"]:
+                extra_total[e] += f["flash"][e]
+                cells.append("(%d)" % f["flash"][e])
+            else:
+                cells.append("-")
+        print("%-20s %10s %10s %10s" % (f["name"], *cells))
+    print("%-20s %10s %10s %10s" % ("gravado", *("%d" % stored_total[e] for e in ENCODINGS)))
+    print("%-20s %10s %10s %10s" % ("não gravado", *("(%d)" % extra_total[e] for e in ENCODINGS)))
+    if compress(b"", "br") is None:
+        print("br não medido: módulo Python brotli ausente")
+
+    summed = [r for f in files for r in f["reps"] if r.get("blocks")]
+    if summed:
+        blocks = sum(len(r["blocks"]) for r in summed)
+        size = sum(b[2] for r in summed for b in r["blocks"])
+        print("checksums pré-calculados: %d bytes em %d blocos (%d bytes de tabela)" % (size, blocks, 8 * blocks))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[2])
+    parser.add_argument("--root", required=True, help="diretório base das URIs")
+    parser.add_argument("--output", required=True, help="arquivo fsdata gerado")
+    parser.add_argument("--checksum-chunk", type=int, default=0,
+                        help="pré-calcula os checksums TCP em blocos deste tamanho (TCP_MSS)")
+    parser.add_argument("--brotli", action="store_true",
+                        help="grava também a variante br dos arquivos estáticos")
+    parser.add_argument("--identity", action="store_true",
+                        help="grava também a variante sem compressão dos arquivos comprimidos")
+    parser.add_argument("--bundle", action="store_true",
+                        help="embute CSS, JS e imagens pequenas em cada página sem SSI")
+    parser.add_argument("--inline-max", type=int, default=4096,
+                        help="maior imagem embutida como data: URI com --bundle (bytes)")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    files = [load(args.root, path) for path in args.files]
+    names = [f["name"] for f in files]
+    if len(set(names)) != len(names):
+        sys.exit("makefsdata: URIs repetidas em %s" % names)
+
+    stored = set()
+    if args.brotli:
+        try:
+            import brotli  # noqa: F401
+        except ImportError:
+            sys.exit("makefsdata: --brotli precisa do módulo Python brotli (pip install brotli)")
+        stored.add("br")
+    if args.identity:
+        stored.add(None)
+
+    referenced = referenced_names(files)
+    bundler = Bundler(files, args.inline_max) if args.bundle else None
+    etags = {}
+    for f in sorted(files, key=lambda f: PROCESS_ORDER.get(f["ext"], 0)):
+        process(f, etags, referenced, stored, bundler)
+    if bundler:
+        files = bundler.prune(files)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w", encoding="utf-8") as out:
+        write_fsdata(out, files, args.checksum_chunk)
+    report(files)
+    if bundler:
+        bundler.report(files)
+
+
+if __name__ == "__main__":
+    main()
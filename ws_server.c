@@ -0,0 +1,425 @@
+/**
+ * @file    ws_server.c
+ * @brief   Servidor WebSocket mínimo sobre a API raw TCP do lwIP
+ * @details Os dados recebidos ficam na cadeia de pbufs até formarem um quadro
+ *          completo, então nenhum buffer grande é reservado por cliente. Só
+ *          quadros com payload de até 125 bytes (ou 126..WS_MAX_PAYLOAD com
+ *          tamanho estendido de 16 bits) são aceitos.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#define LOG_LEVEL 3
+#include "log_vt100.h"
+
+#include "lwip/tcp.h"
+
+#include "ws_server.h"
+
+// WebSocket opcodes (RFC 6455)
+#define WS_OP_CONT      0x0
+#define WS_OP_TEXT      0x1
+#define WS_OP_BINARY    0x2
+#define WS_OP_CLOSE     0x8
+#define WS_OP_PING      0x9
+#define WS_OP_PONG      0xA
+
+// Close status codes
+#define WS_CLOSE_NORMAL         1000
+#define WS_CLOSE_PROTOCOL       1002
+#define WS_CLOSE_UNSUPPORTED    1003
+#define WS_CLOSE_TOO_BIG        1009
+
+static const char ws_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    struct pbuf *rx;        // Received bytes not yet consumed
+    bool open;              // Upgrade completed
+    uint8_t polls;          // Polls since the last received data
+    uint8_t stall;          // Polls with unacknowledged data and no progress
+} ws_client_t;
+
+static ws_client_t clients[WS_MAX_CLIENTS];
+static ws_message_fn message_cb;
+static uint client_count = 0;
+
+// ===== SHA-1 / Base64 for Sec-WebSocket-Accept =====
+
+#define SHA1_ROL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+static void sha1_block(uint32_t h[5], const uint8_t *blk) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)blk[i * 4] << 24 | (uint32_t)blk[i * 4 + 1] << 16 |
+               (uint32_t)blk[i * 4 + 2] << 8 | blk[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = SHA1_ROL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+        uint32_t t = SHA1_ROL(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = SHA1_ROL(b, 30); b = a; a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+// Hash of a message shorter than 120 bytes (key + GUID is 60)
+static void sha1_short(const uint8_t *msg, size_t len, uint8_t out[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint8_t buf[128] = { 0 };
+    size_t blocks = (len + 8) / 64 + 1;
+
+    memcpy(buf, msg, len);
+    buf[len] = 0x80;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) {
+        buf[blocks * 64 - 1 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    for (size_t i = 0; i < blocks; i++) {
+        sha1_block(h, buf + i * 64);
+    }
+    for (int i = 0; i < 20; i++) {
+        out[i] = (uint8_t)(h[i / 4] >> (24 - (i % 4) * 8));
+    }
+}
+
+static size_t base64_encode(const uint8_t *in, size_t len, char *out) {
+    static const char tbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[o++] = tbl[(v >> 18) & 0x3F];
+        out[o++] = tbl[(v >> 12) & 0x3F];
+        out[o++] = (i + 1 < len) ? tbl[(v >> 6) & 0x3F] : '=';
+        out[o++] = (i + 2 < len) ? tbl[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+// ===== Connection handling =====
+
+static void ws_client_free(ws_client_t *c) {
+    if (c->rx) {
+        pbuf_free(c->rx);
+    }
+    memset(c, 0, sizeof(*c));
+    client_count--;
+}
+
+static err_t ws_client_close(ws_client_t *c) {
+    struct tcp_pcb *pcb = c->pcb;
+    err_t ret = ERR_OK;
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        ret = ERR_ABRT;
+    }
+    ws_client_free(c);
+    return ret;
+}
+
+static err_t ws_client_abort(ws_client_t *c) {
+    struct tcp_pcb *pcb = c->pcb;
+    tcp_arg(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_abort(pcb);
+    ws_client_free(c);
+    return ERR_ABRT;
+}
+
+// Queue one unmasked server frame; never waits for buffer space
+static bool ws_send_frame(ws_client_t *c, uint8_t opcode, const uint8_t *data, uint8_t len) {
+    uint8_t hdr[2] = { (uint8_t)(0x80 | opcode), len };
+    if (tcp_sndbuf(c->pcb) < sizeof(hdr) + len) {
+        return false;
+    }
+    if (tcp_write(c->pcb, hdr, sizeof(hdr), TCP_WRITE_FLAG_COPY | (len ? TCP_WRITE_FLAG_MORE : 0)) != ERR_OK) {
+        return false;
+    }
+    if (len && tcp_write(c->pcb, data, len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return false;
+    }
+    tcp_output(c->pcb);
+    return true;
+}
+
+static err_t ws_fail(ws_client_t *c, uint16_t code) {
+    uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)code };
+    LOG_WARN("[WS] Encerrando conexão (codigo %u)", code);
+    ws_send_frame(c, WS_OP_CLOSE, payload, sizeof(payload));
+    return ws_client_close(c);
+}
+
+// Consume bytes from the head of the receive chain and reopen the window
+static void ws_consume(ws_client_t *c, u16_t len) {
+    c->rx = pbuf_free_header(c->rx, len);
+    tcp_recved(c->pcb, len);
+}
+
+static u16_t ws_find_header(struct pbuf *p, u16_t end, const char *name, const char *name_lc) {
+    u16_t pos = pbuf_memfind(p, name, (u16_t)strlen(name), 0);
+    if (pos == 0xFFFF || pos > end) {
+        pos = pbuf_memfind(p, name_lc, (u16_t)strlen(name_lc), 0);
+    }
+    return (pos == 0xFFFF || pos > end) ? 0xFFFF : (u16_t)(pos + strlen(name));
+}
+
+static err_t ws_handshake(ws_client_t *c) {
+    u16_t end = pbuf_memfind(c->rx, "\r\n\r\n", 4, 0);
+    if (end == 0xFFFF) {
+        if (c->rx->tot_len > WS_HANDSHAKE_MAX) {
+            LOG_WARN("[WS] Requisição de upgrade grande demais");
+            return ws_client_abort(c);
+        }
+        return ERR_OK; // wait for the rest of the headers
+    }
+
+    bool path_ok = pbuf_memcmp(c->rx, 0, "GET " WS_SERVER_PATH, 4 + strlen(WS_SERVER_PATH)) == 0;
+    u8_t after = pbuf_get_at(c->rx, 4 + strlen(WS_SERVER_PATH));
+    u16_t key_pos = ws_find_header(c->rx, end, "Sec-WebSocket-Key: ", "sec-websocket-key: ");
+
+    char key[24 + sizeof(ws_guid)];
+    if (!path_ok || (after != ' ' && after != '?') || key_pos == 0xFFFF ||
+        pbuf_copy_partial(c->rx, key, 24, key_pos) != 24) {
+        static const char bad[] = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+        tcp_write(c->pcb, bad, sizeof(bad) - 1, 0);
+        return ws_client_close(c);
+    }
+    memcpy(key + 24, ws_guid, sizeof(ws_guid) - 1);
+
+    uint8_t digest[20];
+    char accept[29];
+    sha1_short((const uint8_t *)key, 24 + sizeof(ws_guid) - 1, digest);
+    base64_encode(digest, sizeof(digest), accept);
+
+    char resp[160];
+    int len = snprintf(resp, sizeof(resp),
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: %s\r\n"
+        "\r\n", accept);
+    if (tcp_write(c->pcb, resp, (u16_t)len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        return ws_client_abort(c);
+    }
+    tcp_output(c->pcb);
+
+    ws_consume(c, end + 4);
+    c->open = true;
+    LOG_INFO("[WS] Cliente conectado (%u ativos)", client_count);
+    return ERR_OK;
+}
+
+static err_t ws_process_frames(ws_client_t *c) {
+    while (c->rx != NULL && c->rx->tot_len >= 2) {
+        uint8_t hdr[8];
+        u16_t avail = c->rx->tot_len;
+        pbuf_copy_partial(c->rx, hdr, avail < sizeof(hdr) ? avail : sizeof(hdr), 0);
+
+        bool fin = hdr[0] & 0x80;
+        uint8_t opcode = hdr[0] & 0x0F;
+        u16_t len = hdr[1] & 0x7F;
+        u16_t pos = 2;
+
+        if (!(hdr[1] & 0x80)) {
+            return ws_fail(c, WS_CLOSE_PROTOCOL); // client frames must be masked
+        }
+        if (len == 126) {
+            if (avail < 4) {
+                return ERR_OK;
+            }
+            len = (u16_t)(hdr[2] << 8 | hdr[3]);
+            pos = 4;
+        } else if (len == 127) {
+            return ws_fail(c, WS_CLOSE_TOO_BIG);
+        }
+        if (len > WS_MAX_PAYLOAD) {
+            return ws_fail(c, WS_CLOSE_TOO_BIG);
+        }
+        if (avail < pos + 4 + len) {
+            return ERR_OK; // frame not complete yet
+        }
+
+        uint8_t mask[4];
+        uint8_t payload[WS_MAX_PAYLOAD];
+        pbuf_copy_partial(c->rx, mask, 4, pos);
+        pbuf_copy_partial(c->rx, payload, len, pos + 4);
+        for (u16_t i = 0; i < len; i++) {
+            payload[i] ^= mask[i & 3];
+        }
+        ws_consume(c, pos + 4 + len);
+
+        switch (opcode) {
+            case WS_OP_BINARY:
+                if (!fin) {
+                    return ws_fail(c, WS_CLOSE_UNSUPPORTED); // no fragmentation
+                }
+                if (message_cb) {
+                    message_cb(payload, len);
+                }
+                break;
+            case WS_OP_PING:
+                if (len <= 125) {
+                    ws_send_frame(c, WS_OP_PONG, payload, (uint8_t)len);
+                }
+                break;
+            case WS_OP_PONG:
+            case WS_OP_TEXT:
+                break; // text frames carry no commands
+            case WS_OP_CLOSE:
+                ws_send_frame(c, WS_OP_CLOSE, payload, len >= 2 ? 2 : 0);
+                return ws_client_close(c);
+            default:
+                return ws_fail(c, WS_CLOSE_UNSUPPORTED);
+        }
+    }
+    return ERR_OK;
+}
+
+static err_t ws_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    ws_client_t *c = (ws_client_t *)arg;
+    if (p == NULL) {
+        return c ? ws_client_close(c) : ERR_OK; // remote closed
+    }
+    if (err != ERR_OK || c == NULL) {
+        pbuf_free(p);
+        return err;
+    }
+
+    c->polls = 0;
+    if (c->rx) {
+        pbuf_cat(c->rx, p);
+    } else {
+        c->rx = p;
+    }
+
+    if (!c->open) {
+        err_t ret = ws_handshake(c);
+        if (ret != ERR_OK || !c->open) {
+            return ret;
+        }
+    }
+    return ws_process_frames(c);
+}
+
+static err_t ws_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    ws_client_t *c = (ws_client_t *)arg;
+    if (c) {
+        c->stall = 0;
+    }
+    return ERR_OK;
+}
+
+static err_t ws_poll(void *arg, struct tcp_pcb *pcb) {
+    ws_client_t *c = (ws_client_t *)arg;
+    if (c == NULL) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    c->polls++;
+    if (!c->open) {
+        return (c->polls >= WS_HANDSHAKE_POLLS) ? ws_client_abort(c) : ERR_OK;
+    }
+
+    // A client that stops acknowledging data is dropped instead of
+    // holding buffers that other connections need
+    if (tcp_sndbuf(pcb) < TCP_SND_BUF && ++c->stall >= WS_STALL_POLLS) {
+        LOG_WARN("[WS] Cliente sem resposta, conexão abortada");
+        return ws_client_abort(c);
+    }
+    if (c->polls >= WS_PING_POLLS) {
+        c->polls = 0;
+        ws_send_frame(c, WS_OP_PING, NULL, 0);
+    }
+    return ERR_OK;
+}
+
+static void ws_error(void *arg, err_t err) {
+    ws_client_t *c = (ws_client_t *)arg;
+    if (c) {
+        c->pcb = NULL; // already freed by lwIP
+        ws_client_free(c);
+    }
+}
+
+static err_t ws_accept(void *arg, struct tcp_pcb *pcb, err_t err) {
+    if (err != ERR_OK || pcb == NULL) {
+        return ERR_VAL;
+    }
+
+    ws_client_t *c = NULL;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].pcb == NULL) {
+            c = &clients[i];
+            break;
+        }
+    }
+    if (c == NULL) {
+        LOG_WARN("[WS] Limite de %d clientes atingido", WS_MAX_CLIENTS);
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    memset(c, 0, sizeof(*c));
+    c->pcb = pcb;
+    client_count++;
+
+    // Commands are tiny and latency-sensitive
+    tcp_nagle_disable(pcb);
+    tcp_arg(pcb, c);
+    tcp_recv(pcb, ws_recv);
+    tcp_sent(pcb, ws_sent);
+    tcp_poll(pcb, ws_poll, WS_POLL_INTERVAL);
+    tcp_err(pcb, ws_error);
+    return ERR_OK;
+}
+
+bool ws_server_init(uint16_t port, ws_message_fn on_message) {
+    message_cb = on_message;
+
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (pcb == NULL) {
+        return false;
+    }
+    if (tcp_bind(pcb, IP_ANY_TYPE, port) != ERR_OK) {
+        tcp_abort(pcb);
+        return false;
+    }
+    struct tcp_pcb *listen = tcp_listen_with_backlog(pcb, WS_MAX_CLIENTS);
+    if (listen == NULL) {
+        tcp_abort(pcb);
+        return false;
+    }
+    tcp_accept(listen, ws_accept);
+    LOG_INFO("[WS] Servidor WebSocket na porta %u (%s)", port, WS_SERVER_PATH);
+    return true;
+}
+
+uint ws_server_client_count(void) {
+    return client_count;
+}
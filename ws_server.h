@@ -0,0 +1,48 @@
+/**
+ * @file    ws_server.h
+ * @brief   Servidor WebSocket mínimo sobre a API raw TCP do lwIP
+ * @details Canal de controle ao lado do httpd: aceita quadros binários
+ *          pequenos (mascarados, não fragmentados) e entrega cada mensagem a
+ *          um callback no contexto do lwIP. O servidor nunca espera pela rede:
+ *          respostas que não cabem no buffer de envio são descartadas e
+ *          clientes que param de confirmar dados são derrubados.
+ *
+ * @project BitDogLab_HTTPDd_workspace
+ * @url     https://github.com/ArvoreDosSaberes/BitDogLab_HTTPDd_workspace
+ *
+ * @license CC BY 4.0 - https://creativecommons.org/licenses/by/4.0/
+ */
+
+#ifndef WS_SERVER_H
+#define WS_SERVER_H
+
+#include "pico/stdlib.h"
+
+#define WS_SERVER_PORT          8080
+#define WS_SERVER_PATH          "/ws"
+
+// Conexões WebSocket simultâneas
+#ifndef WS_MAX_CLIENTS
+#define WS_MAX_CLIENTS          4
+#endif
+
+// Maior payload aceito em um quadro (quadro da matriz = 1 + 75 bytes)
+#define WS_MAX_PAYLOAD          128
+
+// Maior requisição de upgrade aceita (cabeçalhos do navegador)
+#define WS_HANDSHAKE_MAX        1024
+
+// Intervalo do tcp_poll em ticks de 500 ms e limites medidos nesse intervalo
+#define WS_POLL_INTERVAL        4
+#define WS_HANDSHAKE_POLLS      3   // Tempo para concluir o upgrade
+#define WS_PING_POLLS           10  // Ping após esse tempo sem tráfego
+#define WS_STALL_POLLS          5   // Dados sem ACK por esse tempo derrubam o cliente
+
+// Recebe o payload de um quadro binário completo (contexto do lwIP)
+typedef void (*ws_message_fn)(const uint8_t *data, size_t len);
+
+// Funções públicas
+bool ws_server_init(uint16_t port, ws_message_fn on_message);
+uint ws_server_client_count(void);
+
+#endif // WS_SERVER_H